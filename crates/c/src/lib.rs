@@ -2,10 +2,12 @@ mod component_type_object;
 
 use anyhow::Result;
 use heck::*;
-use std::collections::{HashMap, HashSet};
+use std::collections::{BTreeMap, HashMap, HashSet};
 use std::fmt::Write;
 use std::mem;
-use wit_bindgen_core::abi::{self, AbiVariant, Bindgen, Bitcast, Instruction, LiftLower, WasmType};
+use wit_bindgen_core::abi::{
+    self, AbiVariant, Bindgen, Bitcast, Instruction, LiftLower, WasmSignature, WasmType,
+};
 use wit_bindgen_core::{
     dealias, uwrite, uwriteln, wit_parser::*, AnonymousTypeGenerator, Direction, Files,
     InterfaceGenerator as _, Ns, WorldGenerator,
@@ -22,6 +24,7 @@ struct C {
     return_pointer_area_align: usize,
     names: Ns,
     needs_string: bool,
+    needs_memcpy: bool,
     needs_union_int32_float: bool,
     needs_union_float_int32: bool,
     needs_union_int64_double: bool,
@@ -31,6 +34,30 @@ struct C {
     sizes: SizeAlign,
     renamed_interfaces: HashMap<WorldKey, String>,
 
+    async_payloads: HashSet<TypeId>,
+    needs_async_helpers: bool,
+    cpp_adapters: String,
+    /// `owned::` aliases referenced by the C++ helper wrappers, keyed by
+    /// alias name. Recorded while generating imports because the type
+    /// tables are pruned before `finish` runs.
+    cpp_owned_aliases: BTreeMap<String, (String, String)>,
+    /// Adapter function names registered in the `--instrument` counter
+    /// table, in emission order; each adapter indexes its own entry.
+    perf_funcs: Vec<String>,
+    /// Shared import adapter helpers emitted under `--dedup-adapters`,
+    /// keyed by the canonicalized helper text so that structurally
+    /// identical bodies are only generated once.
+    adapter_helpers: HashMap<String, String>,
+    /// Names passed to `--chunk` which matched an imported function, used
+    /// to warn about leftover entries once the world is generated.
+    chunked_funcs: HashSet<String>,
+    /// Types whose `*_free` helper can actually be reached by user code:
+    /// everything handed out in an owned position (import arguments and
+    /// results, exported-function parameters, world-level types) plus the
+    /// types nested inside them. Computed in `preprocess`; `define_dtor`
+    /// skips types outside this set unless `--all-dtors` is passed.
+    dtor_live: HashSet<TypeId>,
+
     world_id: Option<WorldId>,
     dtor_funcs: HashMap<TypeId, String>,
     type_names: HashMap<TypeId, String>,
@@ -99,6 +126,139 @@ pub struct Opts {
     /// Configure the autodropping of borrows in exported functions.
     #[cfg_attr(feature = "clap", arg(long, default_value_t = Enabled::default()))]
     pub autodrop_borrows: Enabled,
+
+    /// Generate non-owning view types and, for each imported function with
+    /// string or list arguments, a `*_view` variant of its wrapper which
+    /// borrows those arguments for the duration of the call.
+    ///
+    /// Views let callers pass slices of preexisting buffers without copying
+    /// them into owned `*_string_t`/list values first; imports never take
+    /// ownership of their arguments so no free is necessary afterwards.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub views: bool,
+
+    /// Allocate all lifted memory from a per-call arena instead of the
+    /// general-purpose allocator.
+    ///
+    /// In this mode `cabi_realloc` bump-allocates out of a chain of arena
+    /// blocks and the generated `*_free` helpers are not emitted; all lifted
+    /// memory is reclaimed at once by the generated `{world}_arena_reset`
+    /// function, which is also invoked automatically in `cabi_post_*`
+    /// functions. Lifted values must not be retained across a call to the
+    /// reset function.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub arena: bool,
+
+    /// Declare the export return area `_Thread_local` instead of `static`.
+    ///
+    /// Exported functions write their lowered results into a return area
+    /// which must stay live until the matching `cabi_post_*` call, so it
+    /// cannot live on the stack. The default single static area is shared by
+    /// all exports, which serializes invocations when exports run
+    /// concurrently under wasi-threads; with this option each thread gets its
+    /// own area. Requires a toolchain with wasm thread-local storage support
+    /// (`-pthread` with LLVM).
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub thread_local_ret_area: bool,
+
+    /// Serve canonical-ABI allocations from size-classed freelists.
+    ///
+    /// The default `cabi_realloc` funnels every allocation through `realloc`,
+    /// so each small lifted string or list pays the full allocator cost. With
+    /// this option blocks of up to 512 bytes are handed out from per-size
+    /// freelists replenished a slab at a time, and the generated
+    /// deallocation code returns them there via `{world}_cabi_free`; larger
+    /// blocks fall back to `malloc`. Memory given to the generated `*_free`
+    /// helpers (for example through `*_string_set`) must have been allocated
+    /// with `cabi_realloc`.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub pool_allocator: bool,
+
+    /// Pack the generated variant, option and result structs.
+    ///
+    /// By default these types mirror their canonical ABI layout: a
+    /// smallest-int discriminant padded up to the alignment of the payload
+    /// union, which wastes most of each element in arrays like
+    /// `list<option<u8>>`. With this option the structs carry
+    /// `__attribute__((packed))`, eliminating the padding; lists whose
+    /// element layout then no longer matches the canonical stride are
+    /// converted element-wise at the boundary instead of being passed as one
+    /// block of memory.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub packed: bool,
+
+    /// Additionally generate a `{world}_helpers.hpp` header of C++ RAII
+    /// wrappers over the C bindings.
+    ///
+    /// The header defines a move-only `unique` owner which calls the
+    /// matching generated `*_free` function on destruction, zero-copy
+    /// `std::string_view`/`std::span` views of generated string and list
+    /// values, and inline overloads of the import wrappers which accept
+    /// views and owning wrappers directly. The wrappers know the exact
+    /// layout of the generated types, so none of the conversions copy.
+    /// Requires C++20 for `std::span`.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub cpp_helpers: bool,
+
+    /// Emit lightweight instrumentation into the generated adapters.
+    ///
+    /// Each adapter then counts its calls, accumulates elapsed ticks of the
+    /// weak `{world}_perf_counter` function (whose default definition
+    /// returns 0 until overridden with a real cycle or time source), and
+    /// records the largest `cabi_realloc` request made while it was the
+    /// innermost active adapter. The generated `{world}_perf_dump` function
+    /// writes one line per called adapter to stderr.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub instrument: bool,
+
+    /// Share one generated body between imports with identical shapes.
+    ///
+    /// Import wrappers whose flattened signatures and lift/lower shapes
+    /// are structurally identical all forward to a single `static` helper
+    /// parameterized by the underlying wasm import's function pointer,
+    /// instead of each carrying a full copy of the lowering code. Worlds
+    /// with many functions over a handful of signatures generate
+    /// substantially less code at the cost of an indirect call per
+    /// import.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub dedup_adapters: bool,
+
+    /// Generate a chunked pull reader for the named imported function.
+    ///
+    /// The function must take trailing unsigned offset and length
+    /// parameters and return a `list<u8>`. A `*_chunked` wrapper is then
+    /// generated which pulls the requested range through repeated calls
+    /// of at most `chunk_size` bytes, hands each chunk to a callback, and
+    /// frees it before pulling the next one, so peak linear memory for
+    /// the transfer is bounded by the chunk size rather than the full
+    /// payload. May be repeated to tag several functions.
+    #[cfg_attr(feature = "clap", arg(long, value_name = "FUNC"))]
+    pub chunk: Vec<String>,
+
+    /// Emit a `*_free` helper for every generated type.
+    ///
+    /// By default the helpers are only generated for types that some
+    /// signature actually hands to user code to own — import arguments
+    /// and results and exported-function parameters, plus everything
+    /// nested inside them. Types used purely as exported-function results
+    /// are released by the generated post-return code and get no helper.
+    /// Pass this flag to force the full set, e.g. when manually freeing a
+    /// result value that was built but never returned.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub all_dtors: bool,
+
+    /// Return constant strings from exports without a per-call copy.
+    ///
+    /// `*_string_set` already stores the caller's pointer without copying,
+    /// but the generated post-return code unconditionally frees returned
+    /// string memory, so exports must otherwise `*_string_dup` even string
+    /// literals. With this option every generated string free first checks
+    /// the pointer against the linker-provided `__heap_base` symbol and
+    /// skips pointers into static data, so exports can hand constants
+    /// straight to `*_string_set`: no allocation, no copy, and no free in
+    /// `cabi_post_*`.
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub static_strings: bool,
 }
 
 #[cfg(feature = "clap")]
@@ -119,7 +279,7 @@ impl Opts {
     }
 }
 
-#[derive(Debug, Default)]
+#[derive(Debug, Default, Clone)]
 struct Return {
     scalar: Option<Scalar>,
     retptrs: Vec<Type>,
@@ -133,7 +293,7 @@ struct CSig {
     retptrs: Vec<String>,
 }
 
-#[derive(Debug)]
+#[derive(Debug, Clone)]
 enum Scalar {
     Void,
     OptionBool(Type),
@@ -141,6 +301,13 @@ enum Scalar {
     Type(Type),
 }
 
+/// Argument shapes which have a non-owning view representation when the
+/// `views` option is enabled.
+enum ViewParam {
+    String,
+    List(Type),
+}
+
 impl WorldGenerator for C {
     fn preprocess(&mut self, resolve: &Resolve, world: WorldId) {
         self.world = self
@@ -168,6 +335,40 @@ impl WorldGenerator for C {
                 }
             }
         }
+
+        // Seed `dtor_live` with every type a signature hands to user code
+        // to own; `add_dtor_live` pulls in the nested types their free
+        // helpers recurse into. Exported-function results are deliberately
+        // not roots: the generated post-return code releases those without
+        // going through `*_free`.
+        let add_func = |dtor_live: &mut HashSet<TypeId>, func: &Function, import: bool| {
+            for (_, ty) in func.params.iter() {
+                add_dtor_live(resolve, dtor_live, ty);
+            }
+            if import {
+                for ty in func.results.iter_types() {
+                    add_dtor_live(resolve, dtor_live, ty);
+                }
+            }
+        };
+        for (import, (_, item)) in world
+            .imports
+            .iter()
+            .map(|i| (true, i))
+            .chain(world.exports.iter().map(|i| (false, i)))
+        {
+            match item {
+                WorldItem::Function(func) => add_func(&mut self.dtor_live, func, import),
+                WorldItem::Interface { id, .. } => {
+                    for (_, func) in resolve.interfaces[*id].functions.iter() {
+                        add_func(&mut self.dtor_live, func, import);
+                    }
+                }
+                WorldItem::Type(id) => {
+                    add_dtor_live(resolve, &mut self.dtor_live, &Type::Id(*id));
+                }
+            }
+        }
     }
 
     fn import_interface(
@@ -282,6 +483,11 @@ impl WorldGenerator for C {
     }
 
     fn finish(&mut self, resolve: &Resolve, id: WorldId, files: &mut Files) -> Result<()> {
+        for name in self.opts.chunk.iter() {
+            if !self.chunked_funcs.contains(name) {
+                eprintln!("warning: chunked reader for `{name}` did not match any imported functions");
+            }
+        }
         let linking_symbol = component_type_object::linking_symbol(&self.world);
         self.c_include("<stdlib.h>");
         let snake = self.world.to_snake_case();
@@ -299,8 +505,126 @@ impl WorldGenerator for C {
            ",
         );
 
+        if self.opts.arena {
+            if !self.needs_string {
+                self.c_include("<string.h>");
+            }
+            uwrite!(
+                self.src.h_helpers,
+                "
+                   // Releases all memory handed out by `cabi_realloc` since the last
+                   // reset. Lifted values must not be used after this is called.
+                   void {snake}_arena_reset(void);
+               ",
+            );
+        }
+
+        if self.opts.pool_allocator {
+            if !self.needs_string {
+                self.c_include("<string.h>");
+            }
+            uwrite!(
+                self.src.h_helpers,
+                "
+                   // Returns a block previously obtained from `cabi_realloc` to the
+                   // allocator's freelists.
+                   void {snake}_cabi_free(void *ptr);
+               ",
+            );
+        }
+
+        if self.needs_async_helpers {
+            let shouty = snake.to_shouty_snake_case();
+            uwrite!(
+                self.src.h_helpers,
+                "
+                   // Status values returned by future/stream reads and writes. Any
+                   // other value is a count of elements transferred, with
+                   // {shouty}_WAITABLE_CLOSED set when the other end was closed; its
+                   // low bits then carry an error-context handle (or 0 for none).
+                   #define {shouty}_WAITABLE_BLOCKED 0xffffffffu
+                   #define {shouty}_WAITABLE_CLOSED 0x80000000u
+                   #define {shouty}_WAITABLE_CANCELED 0u
+
+                   // Events delivered by `{snake}_task_wait`.
+                   #define {shouty}_EVENT_CALL_STARTED 1
+                   #define {shouty}_EVENT_CALL_RETURNED 2
+                   #define {shouty}_EVENT_CALL_DONE 3
+                   #define {shouty}_EVENT_YIELDED 4
+                   #define {shouty}_EVENT_STREAM_READ 5
+                   #define {shouty}_EVENT_STREAM_WRITE 6
+                   #define {shouty}_EVENT_FUTURE_READ 7
+                   #define {shouty}_EVENT_FUTURE_WRITE 8
+
+                   typedef struct {snake}_event_t {{
+                       int32_t event;
+                       int32_t waitable;
+                       uint32_t code;
+                   }} {snake}_event_t;
+
+                   // Blocks until the host reports progress on a pending read, write,
+                   // or async import call, then describes it in `*event`.
+                   void {snake}_task_wait({snake}_event_t *event);
+
+                   // Yields control to the host, allowing other tasks to run.
+                   void {snake}_task_yield(void);
+
+                   // Tells the host to defer (true) or resume (false) new calls into
+                   // this instance.
+                   void {snake}_task_backpressure(bool enabled);
+               ",
+            );
+            uwrite!(
+                self.src.c_helpers,
+                r#"
+__attribute__((__import_module__("$root"), __import_name__("[task-wait]")))
+extern int32_t __wasm_import_{snake}_task_wait(int32_t *);
+
+__attribute__((__import_module__("$root"), __import_name__("[task-yield]")))
+extern void __wasm_import_{snake}_task_yield(void);
+
+__attribute__((__import_module__("$root"), __import_name__("[task-backpressure]")))
+extern void __wasm_import_{snake}_task_backpressure(int32_t);
+
+void {snake}_task_wait({snake}_event_t *event) {{
+    int32_t payload[2];
+    event->event = __wasm_import_{snake}_task_wait(payload);
+    event->waitable = payload[0];
+    event->code = (uint32_t) payload[1];
+}}
+
+void {snake}_task_yield(void) {{
+    __wasm_import_{snake}_task_yield();
+}}
+
+void {snake}_task_backpressure(bool enabled) {{
+    __wasm_import_{snake}_task_backpressure(enabled ? 1 : 0);
+}}
+                "#,
+            );
+        }
+
+        // Wide-copy loads and stores use `memcpy`; pull in `<string.h>` when
+        // nothing else already does.
+        if self.needs_memcpy
+            && !self.needs_string
+            && !self.opts.arena
+            && !self.opts.pool_allocator
+        {
+            self.c_include("<string.h>");
+        }
+
+        if self.opts.instrument && !self.perf_funcs.is_empty() {
+            self.c_include("<stdio.h>");
+            self.print_perf_instrumentation(&snake);
+        }
+
         self.print_intrinsics();
 
+        if self.opts.static_strings {
+            self.print_static_data_guard(&snake);
+        }
+
         if self.needs_string {
             self.c_include("<string.h>");
             let (strlen, size) = match self.opts.string_encoding {
@@ -323,15 +647,22 @@ impl WorldGenerator for C {
                             }}
                         ",
                     );
+                    self.print_utf16_transcode_helpers(&snake);
                     (format!("{snake}_string_len(s)"), 2)
                 }
-                StringEncoding::CompactUTF16 => unimplemented!(),
+                // The compact encoding defaults to the Latin-1 representation
+                // for the nul-terminated helpers; the UTF-16 representation is
+                // handled by the dedicated `*_utf16` helpers.
+                StringEncoding::CompactUTF16 => {
+                    self.h_include("<uchar.h>");
+                    self.print_compact_utf16_helpers(&snake);
+                    (format!("strlen(s)"), 1)
+                }
             };
             let ty = self.char_type();
             let c_string_ty = match self.opts.string_encoding {
-                StringEncoding::UTF8 => "char",
+                StringEncoding::UTF8 | StringEncoding::CompactUTF16 => "char",
                 StringEncoding::UTF16 => "char16_t",
-                StringEncoding::CompactUTF16 => panic!("Compact UTF16 unsupported"),
             };
             uwrite!(
                 self.src.h_helpers,
@@ -348,6 +679,25 @@ impl WorldGenerator for C {
                    void {snake}_string_free({snake}_string_t *ret);\
                ",
             );
+            // In arena mode string memory is reclaimed wholesale by the arena
+            // reset, so freeing an individual string only clears it out.
+            let dealloc = self.dealloc_fn();
+            let guard = if self.opts.static_strings {
+                format!(" && !{snake}_is_static_data(ret->ptr)")
+            } else {
+                String::new()
+            };
+            let free_body = if self.opts.arena {
+                String::new()
+            } else if self.opts.string_encoding == StringEncoding::CompactUTF16 {
+                // The length carries the UTF-16 tag bit, so an empty UTF-16
+                // string has a non-zero `len` with no allocation behind it.
+                format!(
+                    "if ({snake}_string_code_units(ret) > 0{guard}) {{\n    {dealloc}(ret->ptr);\n}}\n"
+                )
+            } else {
+                format!("if (ret->len > 0{guard}) {{\n    {dealloc}(ret->ptr);\n}}\n")
+            };
             uwrite!(
                 self.src.c_helpers,
                 "
@@ -363,14 +713,31 @@ impl WorldGenerator for C {
                    }}
 
                    void {snake}_string_free({snake}_string_t *ret) {{
-                       if (ret->len > 0) {{
-                           free(ret->ptr);
-                       }}
-                       ret->ptr = NULL;
+                       {free_body}ret->ptr = NULL;
                        ret->len = 0;
                    }}
                ",
             );
+            if self.opts.views {
+                uwrite!(
+                    self.src.h_helpers,
+                    "
+                       // Creates a non-owning view of the nul-terminated string `s`.
+                       {snake}_string_view_t {snake}_string_view(const {c_string_ty} *s);
+                   ",
+                );
+                uwrite!(
+                    self.src.c_helpers,
+                    "
+                       {snake}_string_view_t {snake}_string_view(const {c_string_ty} *s) {{
+                           {snake}_string_view_t ret;
+                           ret.ptr = (const {ty}*) s;
+                           ret.len = {strlen};
+                           return ret;
+                       }}
+                   ",
+                );
+            }
         }
         if self.needs_union_int32_float {
             uwriteln!(
@@ -440,6 +807,18 @@ impl WorldGenerator for C {
                 }} {snake}_string_t;",
                 ty = self.char_type(),
             );
+            if self.opts.views {
+                uwriteln!(
+                    h_str,
+                    "
+                    // A non-owning view of string data; never freed.
+                    typedef struct {snake}_string_view_t {{\n\
+                      const {ty} *ptr;\n\
+                      size_t len;\n\
+                    }} {snake}_string_view_t;",
+                    ty = self.char_type(),
+                );
+            }
         }
         if self.src.h_defs.len() > 0 {
             h_str.push_str(&self.src.h_defs);
@@ -469,9 +848,14 @@ impl WorldGenerator for C {
                 c_str,
                 "
                 __attribute__((__aligned__({})))
-                static uint8_t RET_AREA[{}];
+                static {}uint8_t RET_AREA[{}];
                 ",
                 self.return_pointer_area_align,
+                if self.opts.thread_local_ret_area {
+                    "_Thread_local "
+                } else {
+                    ""
+                },
                 self.return_pointer_area_size,
             );
         }
@@ -488,6 +872,10 @@ impl WorldGenerator for C {
 
         files.push(&format!("{snake}.h"), h_str.as_bytes());
         files.push(&format!("{snake}.c"), c_str.as_bytes());
+        if self.opts.cpp_helpers {
+            let hpp = self.finish_cpp_helpers(&snake, version);
+            files.push(&format!("{snake}_helpers.hpp"), hpp.as_bytes());
+        }
         if !self.opts.no_object_file {
             files.push(
                 &format!("{snake}_component_type.o",),
@@ -541,7 +929,10 @@ impl C {
         match self.opts.string_encoding {
             StringEncoding::UTF8 => "uint8_t",
             StringEncoding::UTF16 => "uint16_t",
-            StringEncoding::CompactUTF16 => panic!("Compact UTF16 unsupported"),
+            // The compact encoding stores either Latin-1 bytes or UTF-16 code
+            // units depending on the tag bit in `len`, so the pointer is kept
+            // as raw bytes.
+            StringEncoding::CompactUTF16 => "uint8_t",
         }
     }
 
@@ -582,6 +973,118 @@ impl C {
         }
     }
 
+    /// Renders the `{world}_helpers.hpp` header of C++ RAII wrappers emitted
+    /// when the `cpp-helpers` option is enabled.
+    fn finish_cpp_helpers(&mut self, snake: &str, version: &str) -> wit_bindgen_core::Source {
+        let mut hpp = wit_bindgen_core::Source::default();
+        wit_bindgen_core::generated_preamble(&mut hpp, version);
+        uwriteln!(
+            hpp,
+            "#ifndef __BINDINGS_{0}_HELPERS_HPP
+            #define __BINDINGS_{0}_HELPERS_HPP",
+            self.world.to_shouty_snake_case(),
+        );
+        uwriteln!(hpp, "\n#include \"{snake}.h\"\n");
+        uwriteln!(hpp, "#include <span>");
+        uwriteln!(hpp, "#include <string_view>");
+        uwriteln!(hpp, "\nnamespace {snake} {{");
+        hpp.push_str(
+            "
+            // Move-only owner of a generated C value; calls `Free` on destruction.
+            template <typename T, void (*Free)(T *)>
+            class unique {
+            public:
+                unique() : value_{}, owned_(false) {}
+                explicit unique(T value) : value_(value), owned_(true) {}
+                unique(const unique &) = delete;
+                unique &operator=(const unique &) = delete;
+                unique(unique &&other) noexcept : value_(other.value_), owned_(other.owned_) {
+                    other.owned_ = false;
+                }
+                unique &operator=(unique &&other) noexcept {
+                    if (this != &other) {
+                        reset();
+                        value_ = other.value_;
+                        owned_ = other.owned_;
+                        other.owned_ = false;
+                    }
+                    return *this;
+                }
+                ~unique() { reset(); }
+
+                // Frees the held value, if any.
+                void reset() {
+                    if (owned_) {
+                        owned_ = false;
+                        Free(&value_);
+                    }
+                }
+                // Relinquishes ownership; the caller must free the returned value.
+                T release() {
+                    owned_ = false;
+                    return value_;
+                }
+                T *get() { return &value_; }
+                const T *get() const { return &value_; }
+                T &operator*() { return value_; }
+                const T &operator*() const { return value_; }
+                T *operator->() { return &value_; }
+                const T *operator->() const { return &value_; }
+
+            private:
+                T value_;
+                bool owned_;
+            };
+            ",
+        );
+        if self.needs_string {
+            if let Some((view_ty, char_ty)) = cpp_string_view(self.opts.string_encoding) {
+                uwrite!(
+                    hpp,
+                    "
+                    // Zero-copy view of a generated string.
+                    inline {view_ty} view(const {snake}_string_t &s) {{
+                        return {view_ty}(reinterpret_cast<const {char_ty} *>(s.ptr), s.len);
+                    }}
+                    ",
+                );
+            }
+        }
+        hpp.push_str(
+            "
+            // Zero-copy view of a generated list value as a span of its elements.
+            template <typename List>
+            auto span(const List &list) {
+                return std::span(list.ptr, list.len);
+            }
+            ",
+        );
+        if !self.opts.no_helpers {
+            if self.needs_string {
+                uwriteln!(
+                    hpp,
+                    "\nusing string = unique<{snake}_string_t, {snake}_string_free>;"
+                );
+            }
+            if !self.cpp_owned_aliases.is_empty() {
+                uwriteln!(
+                    hpp,
+                    "\n// Owning aliases for generated types with a `*_free` helper."
+                );
+                uwriteln!(hpp, "namespace owned {{");
+                for (alias, (c_ty, free)) in self.cpp_owned_aliases.iter() {
+                    uwriteln!(hpp, "using {alias} = unique<{c_ty}, {free}>;");
+                }
+                uwriteln!(hpp, "}}  // namespace owned");
+            }
+        }
+        let adapters = mem::take(&mut self.cpp_adapters);
+        hpp.push_str(&adapters);
+        uwriteln!(hpp, "\n}}  // namespace {snake}");
+        uwriteln!(hpp, "\n#endif");
+        hpp
+    }
+
     /// Removes all types from `self.{dtor_funcs,type_names,resources}` which
     /// are redefined in exports.
     ///
@@ -691,6 +1194,74 @@ pub fn imported_types_used_by_exported_interfaces(
     live_import_types
 }
 
+/// Returns whether `ty` has a fixed-size C representation that is
+/// byte-compatible with its canonical ABI layout, meaning a list of such
+/// elements can be transferred as one block of memory.
+///
+/// This is a superset of `Resolve::all_bits_valid`: discriminated unions,
+/// `bool` and `char` admit invalid bit patterns, but the generated C structs
+/// mirror the canonical field offsets exactly and the guest performs no
+/// validation when lifting, so no per-element translation is needed.
+fn is_fixed_layout_type(resolve: &Resolve, ty: &Type) -> bool {
+    match ty {
+        Type::Bool
+        | Type::Char
+        | Type::U8
+        | Type::S8
+        | Type::U16
+        | Type::S16
+        | Type::U32
+        | Type::S32
+        | Type::U64
+        | Type::S64
+        | Type::F32
+        | Type::F64 => true,
+
+        Type::String => false,
+
+        Type::Id(id) => match &resolve.types[*id].kind {
+            TypeDefKind::Type(t) => is_fixed_layout_type(resolve, t),
+
+            TypeDefKind::Enum(_) | TypeDefKind::Flags(_) => true,
+
+            TypeDefKind::Record(r) => r
+                .fields
+                .iter()
+                .all(|f| is_fixed_layout_type(resolve, &f.ty)),
+
+            TypeDefKind::Tuple(t) => t.types.iter().all(|ty| is_fixed_layout_type(resolve, ty)),
+
+            TypeDefKind::Variant(v) => v
+                .cases
+                .iter()
+                .all(|case| match &case.ty {
+                    Some(ty) => is_fixed_layout_type(resolve, ty),
+                    None => true,
+                }),
+
+            TypeDefKind::Option(t) => is_fixed_layout_type(resolve, t),
+
+            TypeDefKind::Result(r) => {
+                r.ok.as_ref()
+                    .map_or(true, |ty| is_fixed_layout_type(resolve, ty))
+                    && r.err
+                        .as_ref()
+                        .map_or(true, |ty| is_fixed_layout_type(resolve, ty))
+            }
+
+            // Lists and handles carry ownership which the per-element code
+            // has to track, so they keep the element-wise path.
+            TypeDefKind::List(_)
+            | TypeDefKind::Resource
+            | TypeDefKind::Handle(_)
+            | TypeDefKind::Future(_)
+            | TypeDefKind::Stream(_)
+            | TypeDefKind::ErrorContext
+            | TypeDefKind::Unknown => false,
+        },
+    }
+}
+
 fn is_prim_type(resolve: &Resolve, ty: &Type) -> bool {
     if let Type::Id(id) = ty {
         is_prim_type_id(resolve, *id)
@@ -780,8 +1351,20 @@ pub fn push_ty_name(resolve: &Resolve, ty: &Type, src: &mut String) {
                     src.push_str("list_");
                     push_ty_name(resolve, ty, src);
                 }
-                TypeDefKind::Future(_) => todo!(),
-                TypeDefKind::Stream(_) => todo!(),
+                TypeDefKind::Future(ty) => {
+                    src.push_str("future");
+                    if let Some(ty) = ty {
+                        src.push_str("_");
+                        push_ty_name(resolve, ty, src);
+                    }
+                }
+                TypeDefKind::Stream(ty) => {
+                    src.push_str("stream");
+                    if let Some(ty) = ty {
+                        src.push_str("_");
+                        push_ty_name(resolve, ty, src);
+                    }
+                }
                 TypeDefKind::ErrorContext => todo!(),
                 TypeDefKind::Handle(Handle::Own(resource)) => {
                     src.push_str("own_");
@@ -917,88 +1500,685 @@ struct InterfaceGenerator<'a> {
 }
 
 impl C {
+    /// Emits the `*_is_static_data` predicate used by the `static_strings`
+    /// option to elide frees of constant data.
+    fn print_static_data_guard(&mut self, snake: &str) {
+        // Declared with the functions rather than the helpers since the
+        // generated post-return code calls it even under `no_helpers`.
+        uwrite!(
+            self.src.h_fns,
+            "
+               // Returns whether `ptr` points into the module's static data
+               // (below the linker-provided `__heap_base`). Generated code
+               // never frees such pointers.
+               bool {snake}_is_static_data(const void *ptr);\
+           ",
+        );
+        self.src.c_fns(&format!(
+            "
+extern unsigned char __heap_base __attribute__((__weak__));
+
+// The linker places all data segments below `__heap_base`, so anything
+// under it cannot have come from `cabi_realloc`. The symbol is weak so
+// builds without wasm-ld's synthetic symbols (native test harnesses)
+// fall back to freeing everything.
+bool {snake}_is_static_data(const void *ptr) {{
+    return &__heap_base != NULL && (uintptr_t) ptr < (uintptr_t) &__heap_base;
+}}
+"
+        ));
+    }
+
     fn print_intrinsics(&mut self) {
         // Note that these intrinsics are declared as `weak` so they can be
         // overridden from some other symbol.
         self.src.c_fns("\n// Canonical ABI intrinsics");
         self.src.c_fns("\n");
-        self.src.c_fns(
+        if self.opts.arena {
+            self.print_arena_intrinsics();
+            return;
+        }
+        if self.opts.pool_allocator {
+            self.print_pool_intrinsics();
+            return;
+        }
+        let hook = self.realloc_hook();
+        self.src.c_fns(&format!(
             r#"
                 __attribute__((__weak__, __export_name__("cabi_realloc")))
-                void *cabi_realloc(void *ptr, size_t old_size, size_t align, size_t new_size) {
+                void *cabi_realloc(void *ptr, size_t old_size, size_t align, size_t new_size) {{
                     (void) old_size;
                     if (new_size == 0) return (void*) align;
-                    void *ret = realloc(ptr, new_size);
+                    {hook}void *ret = realloc(ptr, new_size);
                     if (!ret) abort();
                     return ret;
-                }
+                }}
             "#,
-        );
+        ));
     }
-}
 
-impl Return {
-    fn return_single(
-        &mut self,
-        resolve: &Resolve,
-        ty: &Type,
-        orig_ty: &Type,
-        sig_flattening: bool,
-    ) {
-        let id = match ty {
-            Type::Id(id) => *id,
-            Type::String => {
-                self.retptrs.push(*orig_ty);
-                return;
-            }
-            _ => {
-                self.scalar = Some(Scalar::Type(*orig_ty));
-                return;
-            }
-        };
-        match &resolve.types[id].kind {
-            TypeDefKind::Type(t) => return self.return_single(resolve, t, orig_ty, sig_flattening),
+    /// Line injected into `cabi_realloc` under `--instrument` so allocation
+    /// sizes are attributed to the adapter that triggered them.
+    fn realloc_hook(&self) -> String {
+        if self.opts.instrument && !self.perf_funcs.is_empty() {
+            format!("{}_perf_note_realloc(new_size);
+", self.world.to_snake_case())
+        } else {
+            String::new()
+        }
+    }
 
-            // Flags are returned as their bare values, and enums and handles are scalars
-            TypeDefKind::Flags(_) | TypeDefKind::Enum(_) | TypeDefKind::Handle(_) => {
-                self.scalar = Some(Scalar::Type(*orig_ty));
-                return;
-            }
+    fn print_perf_instrumentation(&mut self, snake: &str) {
+        let count = self.perf_funcs.len();
+        uwrite!(
+            self.src.h_helpers,
+            "
+               // Tick source for the generated instrumentation. The default weak
+               // definition returns 0; override it with a cycle counter or clock
+               // to get meaningful `cycles` figures out of `{snake}_perf_dump`.
+               uint64_t {snake}_perf_counter(void);
+
+               // Writes one line per called adapter to stderr: calls, cumulative
+               // counter ticks spent in the adapter (including the wrapped call),
+               // and the largest single `cabi_realloc` request it triggered.
+               void {snake}_perf_dump(void);
+           ",
+        );
+        self.src.c_fns(&format!(
+            r#"
+                // Instrumentation
 
-            // Unpack optional returns where a boolean discriminant is
-            // returned and then the actual type returned is returned
-            // through a return pointer.
-            TypeDefKind::Option(ty) => {
-                if sig_flattening {
-                    self.scalar = Some(Scalar::OptionBool(*ty));
-                    self.retptrs.push(*ty);
-                    return;
-                }
-            }
+                typedef struct {snake}_perf_entry_t {{
+                    const char *name;
+                    uint64_t calls;
+                    uint64_t cycles;
+                    uint64_t realloc_peak;
+                }} {snake}_perf_entry_t;
 
-            // Unpack a result as a boolean return type, with two
-            // return pointers for ok and err values
-            TypeDefKind::Result(r) => {
-                if sig_flattening {
-                    if let Some(ok) = r.ok {
-                        self.retptrs.push(ok);
-                    }
-                    if let Some(err) = r.err {
-                        self.retptrs.push(err);
-                    }
-                    self.scalar = Some(Scalar::ResultBool(r.ok, r.err));
-                    return;
-                }
-            }
+                static {snake}_perf_entry_t {snake}_perf_table[{count}] = {{
+            "#,
+        ));
+        for name in self.perf_funcs.iter() {
+            uwriteln!(self.src.c_fns, "{{ \"{name}\", 0, 0, 0 }},");
+        }
+        self.src.c_fns(&format!(
+            r#"
+                }};
 
-            // These types are always returned indirectly.
-            TypeDefKind::Tuple(_)
-            | TypeDefKind::Record(_)
-            | TypeDefKind::List(_)
-            | TypeDefKind::Variant(_) => {}
+                static {snake}_perf_entry_t *{snake}_perf_current = NULL;
+
+                __attribute__((__weak__))
+                uint64_t {snake}_perf_counter(void) {{
+                    return 0;
+                }}
+
+                static void {snake}_perf_note_realloc(size_t size) {{
+                    if ({snake}_perf_current != NULL && (uint64_t) size > {snake}_perf_current->realloc_peak) {{
+                        {snake}_perf_current->realloc_peak = (uint64_t) size;
+                    }}
+                }}
+
+                typedef struct {snake}_perf_scope_t {{
+                    {snake}_perf_entry_t *prev;
+                    uint64_t start;
+                }} {snake}_perf_scope_t;
+
+                static {snake}_perf_scope_t {snake}_perf_scope_begin({snake}_perf_entry_t *entry) {{
+                    {snake}_perf_scope_t scope;
+                    scope.prev = {snake}_perf_current;
+                    scope.start = {snake}_perf_counter();
+                    entry->calls++;
+                    {snake}_perf_current = entry;
+                    return scope;
+                }}
+
+                static void {snake}_perf_scope_end({snake}_perf_scope_t *scope) {{
+                    {snake}_perf_current->cycles += {snake}_perf_counter() - scope->start;
+                    {snake}_perf_current = scope->prev;
+                }}
+
+                void {snake}_perf_dump(void) {{
+                    for (size_t i = 0; i < {count}; i++) {{
+                        {snake}_perf_entry_t *e = &{snake}_perf_table[i];
+                        if (e->calls == 0) {{
+                            continue;
+                        }}
+                        fprintf(stderr, "%s: %llu calls, %llu cycles, %llu peak realloc bytes\n",
+                            e->name, (unsigned long long) e->calls,
+                            (unsigned long long) e->cycles,
+                            (unsigned long long) e->realloc_peak);
+                    }}
+                }}
+            "#,
+        ));
+    }
+
+    /// Emits UTF-8 <-> UTF-16 transcoding helpers for the `utf16` string
+    /// encoding.
+    ///
+    /// When the module is built with wasm SIMD128 (`-msimd128`) the all-ASCII
+    /// portions of a string are widened/narrowed 16 bytes at a time and only
+    /// multi-byte sequences take the scalar path; without SIMD the scalar
+    /// loops handle everything.
+    fn print_utf16_transcode_helpers(&mut self, snake: &str) {
+        let dealloc = self.dealloc_fn();
+        uwrite!(
+            self.src.h_helpers,
+            "
+                // Transcodes the UTF-8 data `s` (`len` bytes) into a freshly-allocated
+                // UTF-16 string `ret`. Invalid sequences are replaced with U+FFFD.
+                void {snake}_string_from_utf8({snake}_string_t *ret, const char *s, size_t len);
+
+                // Transcodes the UTF-16 string `s` into freshly-allocated UTF-8 data
+                // returned through `ret`/`ret_len`. Unpaired surrogates are replaced
+                // with U+FFFD. The returned buffer is deallocated with `{dealloc}`.
+                void {snake}_string_to_utf8(uint8_t **ret, size_t *ret_len, const {snake}_string_t *s);
+            ",
+        );
+        self.src.c_helpers(&format!(
+            r#"
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+
+void {snake}_string_from_utf8({snake}_string_t *ret, const char *s, size_t len) {{
+    const uint8_t *src = (const uint8_t *) s;
+    // A UTF-8 sequence never produces more UTF-16 code units than it has bytes.
+    char16_t *dst = (char16_t *) cabi_realloc(NULL, 0, 2, len * 2);
+    size_t i = 0;
+    size_t n = 0;
+    while (i < len) {{
+#ifdef __wasm_simd128__
+        while (i + 16 <= len) {{
+            v128_t chunk = wasm_v128_load(src + i);
+            int mask = wasm_i8x16_bitmask(chunk);
+            if (mask != 0) {{
+                // Copy the ASCII prefix of the chunk, then decode the
+                // multi-byte sequence below.
+                int prefix = __builtin_ctz(mask);
+                for (int k = 0; k < prefix; k++) {{
+                    dst[n++] = src[i++];
+                }}
+                break;
+            }}
+            wasm_v128_store(dst + n, wasm_u16x8_extend_low_u8x16(chunk));
+            wasm_v128_store(dst + n + 8, wasm_u16x8_extend_high_u8x16(chunk));
+            i += 16;
+            n += 16;
+        }}
+        if (i >= len) {{
+            break;
+        }}
+#endif
+        uint8_t b = src[i];
+        // Invalid bytes decode to U+FFFD and advance by one, so stray
+        // continuation bytes after a rejected sequence each produce their
+        // own replacement and the `len`-code-unit bound still holds.
+        uint32_t cp = 0xfffd;
+        size_t adv = 1;
+        size_t rem = len - i;
+        if (b < 0x80) {{
+            cp = b;
+        }} else if ((b & 0xe0) == 0xc0 && rem >= 2 && (src[i + 1] & 0xc0) == 0x80) {{
+            cp = ((uint32_t) (b & 0x1f) << 6) | (src[i + 1] & 0x3f);
+            if (cp < 0x80) {{
+                cp = 0xfffd; // overlong
+            }} else {{
+                adv = 2;
+            }}
+        }} else if ((b & 0xf0) == 0xe0 && rem >= 3 && (src[i + 1] & 0xc0) == 0x80
+                && (src[i + 2] & 0xc0) == 0x80) {{
+            cp = ((uint32_t) (b & 0x0f) << 12) | ((uint32_t) (src[i + 1] & 0x3f) << 6)
+                | (src[i + 2] & 0x3f);
+            if (cp < 0x800 || (cp >= 0xd800 && cp <= 0xdfff)) {{
+                cp = 0xfffd; // overlong or UTF-8-encoded surrogate
+            }} else {{
+                adv = 3;
+            }}
+        }} else if ((b & 0xf8) == 0xf0 && rem >= 4 && (src[i + 1] & 0xc0) == 0x80
+                && (src[i + 2] & 0xc0) == 0x80 && (src[i + 3] & 0xc0) == 0x80) {{
+            cp = ((uint32_t) (b & 0x07) << 18) | ((uint32_t) (src[i + 1] & 0x3f) << 12)
+                | ((uint32_t) (src[i + 2] & 0x3f) << 6) | (src[i + 3] & 0x3f);
+            if (cp < 0x10000 || cp > 0x10ffff) {{
+                cp = 0xfffd; // overlong or beyond U+10FFFF
+            }} else {{
+                adv = 4;
+            }}
+        }}
+        i += adv;
+        if (cp >= 0x10000) {{
+            cp -= 0x10000;
+            dst[n++] = (char16_t) (0xd800 + (cp >> 10));
+            dst[n++] = (char16_t) (0xdc00 + (cp & 0x3ff));
+        }} else {{
+            dst[n++] = (char16_t) cp;
+        }}
+    }}
+    if (n < len) {{
+        dst = (char16_t *) cabi_realloc(dst, len * 2, 2, n * 2);
+    }}
+    ret->ptr = (uint16_t *) dst;
+    ret->len = n;
+}}
+
+void {snake}_string_to_utf8(uint8_t **ret, size_t *ret_len, const {snake}_string_t *s) {{
+    const uint16_t *src = s->ptr;
+    size_t len = s->len;
+    // A UTF-16 code unit never produces more than 3 UTF-8 bytes.
+    uint8_t *dst = (uint8_t *) cabi_realloc(NULL, 0, 1, len * 3);
+    size_t i = 0;
+    size_t n = 0;
+    while (i < len) {{
+#ifdef __wasm_simd128__
+        while (i + 8 <= len) {{
+            v128_t chunk = wasm_v128_load(src + i);
+            int mask = wasm_i16x8_bitmask(wasm_u16x8_gt(chunk, wasm_u16x8_const_splat(0x7f)));
+            if (mask != 0) {{
+                // Copy the ASCII prefix of the chunk, then encode the
+                // non-ASCII unit below.
+                int prefix = __builtin_ctz(mask);
+                for (int k = 0; k < prefix; k++) {{
+                    dst[n++] = (uint8_t) src[i++];
+                }}
+                break;
+            }}
+            wasm_v128_store64_lane(dst + n, wasm_u8x16_narrow_i16x8(chunk, chunk), 0);
+            i += 8;
+            n += 8;
+        }}
+        if (i >= len) {{
+            break;
+        }}
+#endif
+        uint32_t cp = src[i];
+        if (cp >= 0xd800 && cp < 0xdc00 && i + 1 < len && src[i + 1] >= 0xdc00
+            && src[i + 1] < 0xe000) {{
+            cp = 0x10000 + ((cp - 0xd800) << 10) + (src[i + 1] - 0xdc00);
+            i += 2;
+        }} else {{
+            if (cp >= 0xd800 && cp < 0xe000) {{
+                cp = 0xfffd;
+            }}
+            i += 1;
+        }}
+        if (cp < 0x80) {{
+            dst[n++] = (uint8_t) cp;
+        }} else if (cp < 0x800) {{
+            dst[n++] = (uint8_t) (0xc0 | (cp >> 6));
+            dst[n++] = (uint8_t) (0x80 | (cp & 0x3f));
+        }} else if (cp < 0x10000) {{
+            dst[n++] = (uint8_t) (0xe0 | (cp >> 12));
+            dst[n++] = (uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+            dst[n++] = (uint8_t) (0x80 | (cp & 0x3f));
+        }} else {{
+            dst[n++] = (uint8_t) (0xf0 | (cp >> 18));
+            dst[n++] = (uint8_t) (0x80 | ((cp >> 12) & 0x3f));
+            dst[n++] = (uint8_t) (0x80 | ((cp >> 6) & 0x3f));
+            dst[n++] = (uint8_t) (0x80 | (cp & 0x3f));
+        }}
+    }}
+    if (n < len * 3) {{
+        dst = (uint8_t *) cabi_realloc(dst, len * 3, 1, n);
+    }}
+    *ret = dst;
+    *ret_len = n;
+}}
+            "#,
+        ));
+    }
+
+    /// Emits helpers for the `latin1+utf16` string encoding.
+    ///
+    /// Strings carry a dual representation: when the high bit of `len` is set
+    /// `ptr` points at UTF-16 code units, otherwise at Latin-1 bytes. The
+    /// canonical lowering/lifting passes the tagged length through untouched,
+    /// so these helpers are all that is needed to construct and inspect
+    /// values on the guest side.
+    fn print_compact_utf16_helpers(&mut self, snake: &str) {
+        let shouty = snake.to_shouty_snake_case();
+        uwrite!(
+            self.src.h_helpers,
+            "
+                // When this bit is set in `len`, `ptr` points to UTF-16 code units,
+                // otherwise to Latin-1 bytes.
+                #define {shouty}_STRING_UTF16_TAG (((size_t) 1) << (sizeof(size_t) * 8 - 1))
+
+                size_t {snake}_string_len(const char16_t* s);
+
+                // Returns whether `s` currently uses the UTF-16 representation.
+                bool {snake}_string_is_utf16(const {snake}_string_t *s);
+
+                // Returns the number of UTF-16 code units or Latin-1 bytes in `s`.
+                size_t {snake}_string_code_units(const {snake}_string_t *s);
+
+                // Transfers ownership of the nul-terminated UTF-16 string `s` into `ret`.
+                void {snake}_string_set_utf16({snake}_string_t *ret, const char16_t *s);
+
+                // Creates a copy of the nul-terminated UTF-16 string `s` in `ret`.
+                void {snake}_string_dup_utf16({snake}_string_t *ret, const char16_t *s);
+
+                // Re-encodes `s` into a freshly-allocated UTF-16 representation in
+                // `ret`: Latin-1 data is widened, UTF-16 data is copied as-is.
+                void {snake}_string_to_utf16({snake}_string_t *ret, const {snake}_string_t *s);
+            ",
+        );
+        uwrite!(
+            self.src.c_helpers,
+            "
+                size_t {snake}_string_len(const char16_t* s) {{
+                    char16_t* c = (char16_t*)s;
+                    for (; *c; ++c);
+                    return c-s;
+                }}
+
+                bool {snake}_string_is_utf16(const {snake}_string_t *s) {{
+                    return (s->len & {shouty}_STRING_UTF16_TAG) != 0;
+                }}
+
+                size_t {snake}_string_code_units(const {snake}_string_t *s) {{
+                    return s->len & ~{shouty}_STRING_UTF16_TAG;
+                }}
+
+                void {snake}_string_set_utf16({snake}_string_t *ret, const char16_t *s) {{
+                    ret->ptr = (uint8_t*) s;
+                    ret->len = {snake}_string_len(s) | {shouty}_STRING_UTF16_TAG;
+                }}
+
+                void {snake}_string_dup_utf16({snake}_string_t *ret, const char16_t *s) {{
+                    size_t units = {snake}_string_len(s);
+                    ret->ptr = (uint8_t*) cabi_realloc(NULL, 0, 2, units * 2);
+                    memcpy(ret->ptr, s, units * 2);
+                    ret->len = units | {shouty}_STRING_UTF16_TAG;
+                }}
+
+                void {snake}_string_to_utf16({snake}_string_t *ret, const {snake}_string_t *s) {{
+                    size_t units = {snake}_string_code_units(s);
+                    char16_t *dst = (char16_t*) cabi_realloc(NULL, 0, 2, units * 2);
+                    if ({snake}_string_is_utf16(s)) {{
+                        memcpy(dst, s->ptr, units * 2);
+                    }} else {{
+                        for (size_t i = 0; i < units; i++) {{
+                            dst[i] = s->ptr[i];
+                        }}
+                    }}
+                    ret->ptr = (uint8_t*) dst;
+                    ret->len = units | {shouty}_STRING_UTF16_TAG;
+                }}
+            ",
+        );
+    }
+
+    fn print_arena_intrinsics(&mut self) {
+        let snake = self.world.to_snake_case();
+        let hook = self.realloc_hook();
+        // All canonical-ABI allocations are served out of a chain of
+        // bump-allocated blocks which are reclaimed all at once by
+        // `{snake}_arena_reset` rather than through individual `free` calls.
+        self.src.c_fns(&format!(
+            r#"
+                // The header is padded to the maximum canonical alignment so
+                // the data area starting at `block + 1` is 8-aligned and
+                // align=8 requests stay aligned after offsetting from it.
+                typedef struct {snake}_arena_block {{
+                    struct {snake}_arena_block *next;
+                    size_t size;
+                    size_t used;
+                }} __attribute__((__aligned__(8))) {snake}_arena_block;
+
+                static {snake}_arena_block *{snake}_arena_head = NULL;
+
+                static void *{snake}_arena_alloc(size_t align, size_t size) {{
+                    {snake}_arena_block *block = {snake}_arena_head;
+                    size_t offset = 0;
+                    if (block != NULL) {{
+                        offset = (block->used + (align - 1)) & ~(align - 1);
+                    }}
+                    if (block == NULL || offset + size > block->size) {{
+                        size_t block_size = 65536;
+                        if (size > block_size) block_size = size;
+                        block = ({snake}_arena_block *) malloc(sizeof({snake}_arena_block) + block_size);
+                        if (!block) abort();
+                        block->next = {snake}_arena_head;
+                        block->size = block_size;
+                        block->used = 0;
+                        {snake}_arena_head = block;
+                        offset = 0;
+                    }}
+                    block->used = offset + size;
+                    return (uint8_t *) (block + 1) + offset;
+                }}
+
+                void {snake}_arena_reset(void) {{
+                    {snake}_arena_block *block = {snake}_arena_head;
+                    while (block != NULL) {{
+                        {snake}_arena_block *next = block->next;
+                        free(block);
+                        block = next;
+                    }}
+                    {snake}_arena_head = NULL;
+                }}
+
+                __attribute__((__weak__, __export_name__("cabi_realloc")))
+                void *cabi_realloc(void *ptr, size_t old_size, size_t align, size_t new_size) {{
+                    if (new_size == 0) return (void*) align;
+                    {hook}void *ret = {snake}_arena_alloc(align, new_size);
+                    if (ptr != NULL && old_size > 0) {{
+                        memcpy(ret, ptr, old_size < new_size ? old_size : new_size);
+                    }}
+                    return ret;
+                }}
+            "#,
+        ));
+    }
+
+    fn print_pool_intrinsics(&mut self) {
+        let snake = self.world.to_snake_case();
+        let shouty = snake.to_shouty_snake_case();
+        let hook = self.realloc_hook();
+        // Small blocks come from per-size-class freelists; each block is
+        // preceded by an 8-byte header recording its class so it can be
+        // returned to the right list without knowing its size. Blocks above
+        // the largest class fall back to `malloc` with `SIZE_MAX` in the
+        // header. Canonical-ABI alignments never exceed 8 bytes.
+        self.src.c_fns(&format!(
+            r#"
+                #define {shouty}_POOL_CLASSES 6
+
+                typedef union {snake}_pool_header {{
+                    size_t tag;
+                    uint64_t align8;
+                }} {snake}_pool_header;
+
+                static void *{snake}_pool_free_list[{shouty}_POOL_CLASSES];
+
+                static void *{snake}_pool_alloc(size_t align, size_t size) {{
+                    if (align > sizeof({snake}_pool_header)) abort();
+                    size_t tag = 0;
+                    size_t tag_size = 16;
+                    while (tag < {shouty}_POOL_CLASSES && tag_size < size) {{
+                        tag++;
+                        tag_size <<= 1;
+                    }}
+                    {snake}_pool_header *header;
+                    if (tag == {shouty}_POOL_CLASSES) {{
+                        header = ({snake}_pool_header *) malloc(sizeof({snake}_pool_header) + size);
+                        if (!header) abort();
+                        header->tag = SIZE_MAX;
+                        return header + 1;
+                    }}
+                    if ({snake}_pool_free_list[tag] == NULL) {{
+                        // Replenish the class with a slab of blocks linked into its
+                        // freelist; slabs are never returned to the system.
+                        size_t step = sizeof({snake}_pool_header) + tag_size;
+                        uint8_t *slab = (uint8_t *) malloc(step * 16);
+                        if (!slab) abort();
+                        for (size_t i = 0; i < 16; i++) {{
+                            void **block = (void **) (slab + i * step + sizeof({snake}_pool_header));
+                            *block = {snake}_pool_free_list[tag];
+                            {snake}_pool_free_list[tag] = block;
+                        }}
+                    }}
+                    void **block = (void **) {snake}_pool_free_list[tag];
+                    {snake}_pool_free_list[tag] = *block;
+                    header = ({snake}_pool_header *) block - 1;
+                    header->tag = tag;
+                    return block;
+                }}
+
+                void {snake}_cabi_free(void *ptr) {{
+                    if (ptr == NULL) return;
+                    {snake}_pool_header *header = ({snake}_pool_header *) ptr - 1;
+                    if (header->tag == SIZE_MAX) {{
+                        free(header);
+                        return;
+                    }}
+                    *(void **) ptr = {snake}_pool_free_list[header->tag];
+                    {snake}_pool_free_list[header->tag] = ptr;
+                }}
+
+                __attribute__((__weak__, __export_name__("cabi_realloc")))
+                void *cabi_realloc(void *ptr, size_t old_size, size_t align, size_t new_size) {{
+                    if (new_size == 0) return (void*) align;
+                    {hook}void *ret = {snake}_pool_alloc(align, new_size);
+                    if (ptr != NULL && old_size > 0) {{
+                        memcpy(ret, ptr, old_size < new_size ? old_size : new_size);
+                        {snake}_cabi_free(ptr);
+                    }}
+                    return ret;
+                }}
+            "#,
+        ));
+    }
+
+    /// Name of the function generated code calls to release memory that was
+    /// allocated through `cabi_realloc`.
+    fn dealloc_fn(&self) -> String {
+        if self.opts.pool_allocator {
+            format!("{}_cabi_free", self.world.to_snake_case())
+        } else {
+            "free".into()
+        }
+    }
+
+    /// Returns whether the C representation of `ty` diverges from its
+    /// canonical ABI layout under the `packed` option.
+    ///
+    /// Packing a discriminated union changes its layout exactly when the
+    /// canonical layout padded the discriminant up to the payload alignment
+    /// or rounded the total size up; either happens precisely when the
+    /// payload's canonical alignment exceeds the discriminant size.
+    /// Divergent types (and aggregates containing them) must not be
+    /// transferred as raw blocks of memory.
+    fn packed_layout_divergent(&self, resolve: &Resolve, ty: &Type) -> bool {
+        if !self.opts.packed {
+            return false;
+        }
+        self.packed_divergence_inner(resolve, ty)
+    }
+
+    fn packed_divergence_inner(&self, resolve: &Resolve, ty: &Type) -> bool {
+        let payload_breaks = |payload: &Type, tag_size: usize| {
+            self.packed_divergence_inner(resolve, payload)
+                || self.sizes.align(payload).align_wasm32() > tag_size
+        };
+        let Type::Id(id) = ty else { return false };
+        match &resolve.types[*id].kind {
+            TypeDefKind::Type(t) => self.packed_divergence_inner(resolve, t),
+            TypeDefKind::Record(r) => r
+                .fields
+                .iter()
+                .any(|f| self.packed_divergence_inner(resolve, &f.ty)),
+            TypeDefKind::Tuple(t) => t
+                .types
+                .iter()
+                .any(|ty| self.packed_divergence_inner(resolve, ty)),
+            TypeDefKind::Variant(v) => {
+                let tag_size = match v.tag() {
+                    Int::U8 => 1,
+                    Int::U16 => 2,
+                    Int::U32 | Int::U64 => 4,
+                };
+                v.cases.iter().any(|case| match &case.ty {
+                    Some(ty) => payload_breaks(ty, tag_size),
+                    None => false,
+                })
+            }
+            TypeDefKind::Option(t) => payload_breaks(t, 1),
+            TypeDefKind::Result(r) => r
+                .ok
+                .iter()
+                .chain(r.err.iter())
+                .any(|ty| payload_breaks(ty, 1)),
+            _ => false,
+        }
+    }
+}
+
+impl Return {
+    fn return_single(
+        &mut self,
+        resolve: &Resolve,
+        ty: &Type,
+        orig_ty: &Type,
+        sig_flattening: bool,
+    ) {
+        let id = match ty {
+            Type::Id(id) => *id,
+            Type::String => {
+                self.retptrs.push(*orig_ty);
+                return;
+            }
+            _ => {
+                self.scalar = Some(Scalar::Type(*orig_ty));
+                return;
+            }
+        };
+        match &resolve.types[id].kind {
+            TypeDefKind::Type(t) => return self.return_single(resolve, t, orig_ty, sig_flattening),
+
+            // Flags are returned as their bare values, and enums, handles,
+            // futures, and streams are scalars
+            TypeDefKind::Flags(_)
+            | TypeDefKind::Enum(_)
+            | TypeDefKind::Handle(_)
+            | TypeDefKind::Future(_)
+            | TypeDefKind::Stream(_) => {
+                self.scalar = Some(Scalar::Type(*orig_ty));
+                return;
+            }
+
+            // Unpack optional returns where a boolean discriminant is
+            // returned and then the actual type returned is returned
+            // through a return pointer.
+            TypeDefKind::Option(ty) => {
+                if sig_flattening {
+                    self.scalar = Some(Scalar::OptionBool(*ty));
+                    self.retptrs.push(*ty);
+                    return;
+                }
+            }
+
+            // Unpack a result as a boolean return type, with two
+            // return pointers for ok and err values
+            TypeDefKind::Result(r) => {
+                if sig_flattening {
+                    if let Some(ok) = r.ok {
+                        self.retptrs.push(ok);
+                    }
+                    if let Some(err) = r.err {
+                        self.retptrs.push(err);
+                    }
+                    self.scalar = Some(Scalar::ResultBool(r.ok, r.err));
+                    return;
+                }
+            }
+
+            // These types are always returned indirectly.
+            TypeDefKind::Tuple(_)
+            | TypeDefKind::Record(_)
+            | TypeDefKind::List(_)
+            | TypeDefKind::Variant(_) => {}
 
-            TypeDefKind::Future(_) => todo!("return_single for future"),
-            TypeDefKind::Stream(_) => todo!("return_single for stream"),
             TypeDefKind::ErrorContext => todo!("return_single for error-context"),
             TypeDefKind::Resource => todo!("return_single for resource"),
             TypeDefKind::Unknown => unreachable!(),
@@ -1251,7 +2431,7 @@ void __wasm_export_{ns}_{snake}_dtor({ns}_{snake}_t* arg) {{
             }
             self.src.h_defs("} val;\n");
         }
-        self.finish_typedef_struct(id);
+        self.finish_packable_typedef_struct(id);
 
         if variant.cases.len() > 0 {
             self.src.h_defs("\n");
@@ -1275,7 +2455,7 @@ void __wasm_export_{ns}_{snake}_dtor({ns}_{snake}_t* arg) {{
         self.src.h_defs("bool is_some;\n");
         self.print_ty(SourceType::HDefs, payload);
         self.src.h_defs(" val;\n");
-        self.finish_typedef_struct(id);
+        self.finish_packable_typedef_struct(id);
     }
 
     fn type_result(&mut self, id: TypeId, _name: &str, result: &Result_, docs: &Docs) {
@@ -1295,7 +2475,7 @@ void __wasm_export_{ns}_{snake}_dtor({ns}_{snake}_t* arg) {{
             }
             self.src.h_defs("} val;\n");
         }
-        self.finish_typedef_struct(id);
+        self.finish_packable_typedef_struct(id);
     }
 
     fn type_enum(&mut self, id: TypeId, name: &str, enum_: &Enum, docs: &Docs) {
@@ -1347,14 +2527,23 @@ void __wasm_export_{ns}_{snake}_dtor({ns}_{snake}_t* arg) {{
         self.finish_typedef_struct(id);
     }
 
-    fn type_future(&mut self, id: TypeId, name: &str, ty: &Option<Type>, docs: &Docs) {
-        _ = (id, name, ty, docs);
-        todo!()
+    fn type_future(&mut self, id: TypeId, _name: &str, _ty: &Option<Type>, docs: &Docs) {
+        // Futures are represented as the handle of one end; helpers to
+        // create, read, write, and close them are generated alongside the
+        // first function whose signature mentions the type.
+        self.src.h_defs("\n");
+        self.docs(docs, SourceType::HDefs);
+        self.start_typedef_struct(id);
+        self.src.h_defs("int32_t __handle;\n");
+        self.finish_typedef_struct(id);
     }
 
-    fn type_stream(&mut self, id: TypeId, name: &str, ty: &Option<Type>, docs: &Docs) {
-        _ = (id, name, ty, docs);
-        todo!()
+    fn type_stream(&mut self, id: TypeId, _name: &str, _ty: &Option<Type>, docs: &Docs) {
+        self.src.h_defs("\n");
+        self.docs(docs, SourceType::HDefs);
+        self.start_typedef_struct(id);
+        self.src.h_defs("int32_t __handle;\n");
+        self.finish_typedef_struct(id);
     }
 
     fn type_error_context(&mut self, id: TypeId, name: &str, docs: &Docs) {
@@ -1404,8 +2593,8 @@ impl<'a> wit_bindgen_core::AnonymousTypeGenerator<'a> for InterfaceGenerator<'a>
         self.src.h_defs("bool is_some;\n");
         let ty = self.gen.type_name(ty);
         uwriteln!(self.src.h_defs, "{ty} val;");
-        self.src.h_defs("}");
-        self.src.h_defs(" ");
+        self.src.h_defs("} ");
+        self.src.h_defs(self.packed_attr());
         self.print_typedef_target(id);
     }
 
@@ -1430,8 +2619,8 @@ impl<'a> wit_bindgen_core::AnonymousTypeGenerator<'a> for InterfaceGenerator<'a>
             }
             self.src.h_defs("} val;\n");
         }
-        self.src.h_defs("}");
-        self.src.h_defs(" ");
+        self.src.h_defs("} ");
+        self.src.h_defs(self.packed_attr());
         self.print_typedef_target(id);
     }
 
@@ -1446,12 +2635,22 @@ impl<'a> wit_bindgen_core::AnonymousTypeGenerator<'a> for InterfaceGenerator<'a>
         self.print_typedef_target(id);
     }
 
-    fn anonymous_type_future(&mut self, _id: TypeId, _ty: &Option<Type>, _docs: &Docs) {
-        todo!("print_anonymous_type for future");
+    fn anonymous_type_future(&mut self, id: TypeId, _ty: &Option<Type>, _docs: &Docs) {
+        self.src.h_defs("\ntypedef ");
+        self.src.h_defs("struct {\n");
+        self.src.h_defs("int32_t __handle;\n");
+        self.src.h_defs("}");
+        self.src.h_defs(" ");
+        self.print_typedef_target(id);
     }
 
-    fn anonymous_type_stream(&mut self, _id: TypeId, _ty: &Option<Type>, _docs: &Docs) {
-        todo!("print_anonymous_type for stream");
+    fn anonymous_type_stream(&mut self, id: TypeId, _ty: &Option<Type>, _docs: &Docs) {
+        self.src.h_defs("\ntypedef ");
+        self.src.h_defs("struct {\n");
+        self.src.h_defs("int32_t __handle;\n");
+        self.src.h_defs("}");
+        self.src.h_defs(" ");
+        self.print_typedef_target(id);
     }
 
     fn anonymous_type_error_context(&mut self) {
@@ -1555,6 +2754,19 @@ impl InterfaceGenerator<'_> {
     }
 
     fn define_dtor(&mut self, id: TypeId) {
+        // With a per-call arena there is nothing to free per-value; everything
+        // is reclaimed by `{world}_arena_reset`.
+        if self.gen.opts.arena {
+            return;
+        }
+
+        // Skip helpers user code can never reach; types used purely as
+        // exported-function results are released by the generated
+        // post-return code instead.
+        if !self.gen.opts.all_dtors && !self.gen.dtor_live.contains(&id) {
+            return;
+        }
+
         let h_helpers_start = self.src.h_helpers.len();
         let c_helpers_start = self.src.c_helpers.len();
 
@@ -1595,7 +2807,7 @@ impl InterfaceGenerator<'_> {
                     .c_helpers("for (size_t i = 0; i < list_len; i++) {\n");
                 self.free(t, "&list_ptr[i]");
                 self.src.c_helpers("}\n");
-                uwriteln!(self.src.c_helpers, "free(list_ptr);");
+                uwriteln!(self.src.c_helpers, "{}(list_ptr);", self.gen.dealloc_fn());
                 uwriteln!(self.src.c_helpers, "}}");
             }
 
@@ -1604,8 +2816,8 @@ impl InterfaceGenerator<'_> {
                 for (i, case) in v.cases.iter().enumerate() {
                     if let Some(ty) = &case.ty {
                         uwriteln!(self.src.c_helpers, "case {}: {{", i);
-                        let expr = format!("&ptr->val.{}", to_c_ident(&case.name));
-                        self.free(ty, &expr);
+                        let expr = format!("ptr->val.{}", to_c_ident(&case.name));
+                        self.free_payload(ty, &expr);
                         self.src.c_helpers("break;\n");
                         self.src.c_helpers("}\n");
                     }
@@ -1615,23 +2827,26 @@ impl InterfaceGenerator<'_> {
 
             TypeDefKind::Option(t) => {
                 self.src.c_helpers("if (ptr->is_some) {\n");
-                self.free(t, "&ptr->val");
+                self.free_payload(t, "ptr->val");
                 self.src.c_helpers("}\n");
             }
 
             TypeDefKind::Result(r) => {
                 self.src.c_helpers("if (!ptr->is_err) {\n");
                 if let Some(ok) = &r.ok {
-                    self.free(ok, "&ptr->val.ok");
+                    self.free_payload(ok, "ptr->val.ok");
                 }
                 if let Some(err) = &r.err {
                     self.src.c_helpers("} else {\n");
-                    self.free(err, "&ptr->val.err");
+                    self.free_payload(err, "ptr->val.err");
                 }
                 self.src.c_helpers("}\n");
             }
-            TypeDefKind::Future(_) => todo!("print_dtor for future"),
-            TypeDefKind::Stream(_) => todo!("print_dtor for stream"),
+            // Future and stream ends, like resource handles, are closed
+            // explicitly by the user through the generated `*_close_*`
+            // helpers rather than by dtors.
+            TypeDefKind::Future(_) => {}
+            TypeDefKind::Stream(_) => {}
             TypeDefKind::ErrorContext => todo!("print_dtor for error-context"),
             TypeDefKind::Resource => {}
             TypeDefKind::Handle(Handle::Borrow(id) | Handle::Own(id)) => {
@@ -1648,6 +2863,30 @@ impl InterfaceGenerator<'_> {
         self.gen.dtor_funcs.insert(id, format!("{prefix}_free"));
     }
 
+    /// Frees the variant/option/result payload `expr` like [`Self::free`],
+    /// but through an aligned copy under the `packed` option, since payload
+    /// members of packed structs cannot have their address taken directly.
+    fn free_payload(&mut self, ty: &Type, expr: &str) {
+        if self.gen.opts.packed && !self.free_is_noop(ty) {
+            let mut t_name = String::new();
+            self.gen.push_type_name(ty, &mut t_name);
+            self.src
+                .c_helpers(&format!("{t_name} val_copy = {expr};\n"));
+            self.free(ty, "&val_copy");
+        } else {
+            self.free(ty, &format!("&{expr}"));
+        }
+    }
+
+    /// Returns whether [`Self::free`] would emit nothing for `ty`.
+    fn free_is_noop(&self, ty: &Type) -> bool {
+        match ty {
+            Type::Id(id) => !self.gen.dtor_funcs.contains_key(id),
+            Type::String => false,
+            _ => true,
+        }
+    }
+
     fn free(&mut self, ty: &Type, expr: &str) {
         match ty {
             Type::Id(id) => {
@@ -1686,122 +2925,1110 @@ impl InterfaceGenerator<'_> {
         )
     }
 
-    fn import(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
-        self.docs(&func.docs, SourceType::HFns);
-        let sig = self.resolve.wasm_signature(AbiVariant::GuestImport, func);
+    /// Generates the canonical future/stream built-ins for every future and
+    /// stream type appearing in `func`'s signature, the first time each type
+    /// is seen.
+    ///
+    /// The built-ins are instantiated per function occurrence by the
+    /// component model, so the intrinsics are named after the first function
+    /// that mentions the type; any instantiation works for all values of the
+    /// same type. Reads and writes pass a pointer to the C value directly:
+    /// the generated C layout of every type coincides with its canonical ABI
+    /// layout, so no separate lowering buffer is needed.
+    fn generate_payloads(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
+        for (index, ty) in func
+            .find_futures_and_streams(self.resolve)
+            .into_iter()
+            .enumerate()
+        {
+            if !self.gen.async_payloads.insert(ty) {
+                continue;
+            }
+            self.gen.needs_async_helpers = true;
+            let module = format!(
+                "{}{}",
+                if self.in_import {
+                    "[import-payload]"
+                } else {
+                    "[export-payload]"
+                },
+                interface_name
+                    .map(|key| self.resolve.name_world_key(key))
+                    .unwrap_or_else(|| "$root".into())
+            );
+            let func_name = &func.name;
+            let name = self.gen.type_name(&Type::Id(ty));
+            let prefix = name.strip_suffix("_t").unwrap_or(&name).to_string();
+            let world = self.gen.world.to_snake_case();
+            let shouty = world.to_shouty_snake_case();
+            match &self.resolve.types[ty].kind {
+                TypeDefKind::Future(payload) => {
+                    // Bound as single format arguments so the `Source`
+                    // line-trimming doesn't eat the space before the
+                    // parameter name.
+                    let w = format!("{name} w");
+                    let r = format!("{name} r");
+                    let (value_param, read_param, write_arg, read_arg) = match payload {
+                        Some(t) => {
+                            let pt = self.gen.type_name(t);
+                            (
+                                format!(", const {pt} *value"),
+                                format!(", {pt} *dst"),
+                                "(uint8_t *) value".to_string(),
+                                "(uint8_t *) dst".to_string(),
+                            )
+                        }
+                        None => (
+                            String::new(),
+                            String::new(),
+                            "NULL".to_string(),
+                            "NULL".to_string(),
+                        ),
+                    };
+                    uwrite!(
+                        self.src.h_helpers,
+                        "
+                           // Creates a new `{name}`; the returned handle is the writable end.
+                           {name} {prefix}_new(void);
 
-        self.src.c_fns("\n");
+                           // Begins writing `*value` to the writable end `w`. Returns
+                           // {shouty}_WAITABLE_BLOCKED when completion is delivered later
+                           // through `{world}_task_wait`, otherwise the final status.
+                           uint32_t {prefix}_write({w}{value_param});
 
-        // In the private C file, print a function declaration which is the
-        // actual wasm import that we'll be calling, and this has the raw wasm
-        // signature.
-        uwriteln!(
-            self.src.c_fns,
-            "__attribute__((__import_module__(\"{}\"), __import_name__(\"{}\")))",
-            match interface_name {
-                Some(name) => self.resolve.name_world_key(name),
-                None => "$root".to_string(),
-            },
-            func.name
-        );
-        let name = self.c_func_name(interface_name, func);
-        let import_name = self.gen.names.tmp(&format!("__wasm_import_{name}",));
-        self.src.c_fns("extern ");
-        match sig.results.len() {
-            0 => self.src.c_fns("void"),
-            1 => self.src.c_fns(wasm_type(sig.results[0])),
-            _ => unimplemented!("multi-value return not supported"),
-        }
-        self.src.c_fns(" ");
-        self.src.c_fns(&import_name);
-        self.src.c_fns("(");
-        for (i, param) in sig.params.iter().enumerate() {
-            if i > 0 {
-                self.src.c_fns(", ");
-            }
-            self.src.c_fns(wasm_type(*param));
+                           // Begins reading from the readable end `r` into `*dst`.
+                           uint32_t {prefix}_read({r}{read_param});
+
+                           // Cancels an in-progress write or read on the given end.
+                           uint32_t {prefix}_cancel_write({w});
+                           uint32_t {prefix}_cancel_read({r});
+
+                           // Closes one end; `err` is an error-context handle or 0 for none.
+                           void {prefix}_close_writable({w}, uint32_t err);
+                           void {prefix}_close_readable({r});
+                       ",
+                    );
+                    uwrite!(
+                        self.src.c_helpers,
+                        r#"
+__attribute__((__import_module__("{module}"), __import_name__("[future-new-{index}]{func_name}")))
+extern int32_t __wasm_import_{prefix}_new(void);
+
+__attribute__((__import_module__("{module}"), __import_name__("[async][future-write-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_write(int32_t, uint8_t *);
+
+__attribute__((__import_module__("{module}"), __import_name__("[async][future-read-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_read(int32_t, uint8_t *);
+
+__attribute__((__import_module__("{module}"), __import_name__("[future-cancel-write-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_cancel_write(int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[future-cancel-read-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_cancel_read(int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[future-close-writable-{index}]{func_name}")))
+extern void __wasm_import_{prefix}_close_writable(int32_t, int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[future-close-readable-{index}]{func_name}")))
+extern void __wasm_import_{prefix}_close_readable(int32_t);
+
+{name} {prefix}_new(void) {{
+    return ({name}) {{ __wasm_import_{prefix}_new() }};
+}}
+
+uint32_t {prefix}_write({w}{value_param}) {{
+    return __wasm_import_{prefix}_write(w.__handle, {write_arg});
+}}
+
+uint32_t {prefix}_read({r}{read_param}) {{
+    return __wasm_import_{prefix}_read(r.__handle, {read_arg});
+}}
+
+uint32_t {prefix}_cancel_write({w}) {{
+    return __wasm_import_{prefix}_cancel_write(w.__handle);
+}}
+
+uint32_t {prefix}_cancel_read({r}) {{
+    return __wasm_import_{prefix}_cancel_read(r.__handle);
+}}
+
+void {prefix}_close_writable({w}, uint32_t err) {{
+    __wasm_import_{prefix}_close_writable(w.__handle, (int32_t) err);
+}}
+
+void {prefix}_close_readable({r}) {{
+    __wasm_import_{prefix}_close_readable(r.__handle);
+}}
+                        "#,
+                    );
+                }
+                TypeDefKind::Stream(payload) => {
+                    let w = format!("{name} w");
+                    let r = format!("{name} r");
+                    let (value_param, read_param, write_arg, read_arg) = match payload {
+                        Some(t) => {
+                            let pt = self.gen.type_name(t);
+                            (
+                                format!(", const {pt} *values"),
+                                format!(", {pt} *dst"),
+                                "(uint8_t *) values".to_string(),
+                                "(uint8_t *) dst".to_string(),
+                            )
+                        }
+                        None => (
+                            String::new(),
+                            String::new(),
+                            "NULL".to_string(),
+                            "NULL".to_string(),
+                        ),
+                    };
+                    uwrite!(
+                        self.src.h_helpers,
+                        "
+                           // Creates a new `{name}`; the returned handle is the writable end.
+                           {name} {prefix}_new(void);
+
+                           // Begins writing `n` elements to the writable end `w`. Returns
+                           // {shouty}_WAITABLE_BLOCKED when completion is delivered later
+                           // through `{world}_task_wait`, otherwise the number of elements
+                           // accepted or the final status.
+                           uint32_t {prefix}_write({w}{value_param}, size_t n);
+
+                           // Begins reading up to `n` elements from the readable end `r`.
+                           uint32_t {prefix}_read({r}{read_param}, size_t n);
+
+                           // Cancels an in-progress write or read on the given end.
+                           uint32_t {prefix}_cancel_write({w});
+                           uint32_t {prefix}_cancel_read({r});
+
+                           // Closes one end; `err` is an error-context handle or 0 for none.
+                           void {prefix}_close_writable({w}, uint32_t err);
+                           void {prefix}_close_readable({r});
+                       ",
+                    );
+                    uwrite!(
+                        self.src.c_helpers,
+                        r#"
+__attribute__((__import_module__("{module}"), __import_name__("[stream-new-{index}]{func_name}")))
+extern int32_t __wasm_import_{prefix}_new(void);
+
+__attribute__((__import_module__("{module}"), __import_name__("[async][stream-write-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_write(int32_t, uint8_t *, uint32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[async][stream-read-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_read(int32_t, uint8_t *, uint32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[stream-cancel-write-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_cancel_write(int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[stream-cancel-read-{index}]{func_name}")))
+extern uint32_t __wasm_import_{prefix}_cancel_read(int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[stream-close-writable-{index}]{func_name}")))
+extern void __wasm_import_{prefix}_close_writable(int32_t, int32_t);
+
+__attribute__((__import_module__("{module}"), __import_name__("[stream-close-readable-{index}]{func_name}")))
+extern void __wasm_import_{prefix}_close_readable(int32_t);
+
+{name} {prefix}_new(void) {{
+    return ({name}) {{ __wasm_import_{prefix}_new() }};
+}}
+
+uint32_t {prefix}_write({w}{value_param}, size_t n) {{
+    return __wasm_import_{prefix}_write(w.__handle, {write_arg}, (uint32_t) n);
+}}
+
+uint32_t {prefix}_read({r}{read_param}, size_t n) {{
+    return __wasm_import_{prefix}_read(r.__handle, {read_arg}, (uint32_t) n);
+}}
+
+uint32_t {prefix}_cancel_write({w}) {{
+    return __wasm_import_{prefix}_cancel_write(w.__handle);
+}}
+
+uint32_t {prefix}_cancel_read({r}) {{
+    return __wasm_import_{prefix}_cancel_read(r.__handle);
+}}
+
+void {prefix}_close_writable({w}, uint32_t err) {{
+    __wasm_import_{prefix}_close_writable(w.__handle, (int32_t) err);
+}}
+
+void {prefix}_close_readable({r}) {{
+    __wasm_import_{prefix}_close_readable(r.__handle);
+}}
+                        "#,
+                    );
+                }
+                _ => unreachable!(),
+            }
+        }
+    }
+
+    /// Registers `name` in the instrumentation table and returns the
+    /// scope-guard declaration that opens its adapter body. The guard's
+    /// cleanup attribute closes the measurement on every return path.
+    fn perf_prologue(&mut self, name: &str) -> String {
+        let snake = self.gen.world.to_snake_case();
+        let idx = self.gen.perf_funcs.len();
+        self.gen.perf_funcs.push(name.to_string());
+        format!(
+            "__attribute__((__cleanup__({snake}_perf_scope_end))) \
+             {snake}_perf_scope_t perf_scope = {snake}_perf_scope_begin(&{snake}_perf_table[{idx}]);\n"
+        )
+    }
+
+    /// Payload type of `ty` when it is an `option` parameter that
+    /// signature flattening turns into a `maybe_*` pointer.
+    fn flattened_option_param(&self, ty: &Type) -> Option<Type> {
+        if self.gen.opts.no_sig_flattening {
+            return None;
+        }
+        if let Type::Id(id) = ty {
+            if let TypeDefKind::Option(t) = &self.resolve.types[*id].kind {
+                return Some(*t);
+            }
+        }
+        None
+    }
+
+    /// Returns the name of the shared adapter helper for `func`'s shape,
+    /// generating it if this is the first function with that shape.
+    ///
+    /// The helper body is produced with positional parameter names and
+    /// calls the underlying wasm import through a trailing function
+    /// pointer, so any two imports with the same flattened signature and
+    /// the same lift/lower shape canonicalize to byte-identical text.
+    /// That text keys a world-level table: the first function with a
+    /// given shape emits the helper and every later one forwards to it.
+    fn shared_adapter(&mut self, func: &Function, c_sig: &CSig, wasm_sig: &WasmSignature) -> String {
+        let canon_sig = CSig {
+            name: c_sig.name.clone(),
+            sig: String::new(),
+            params: c_sig
+                .params
+                .iter()
+                .enumerate()
+                .map(|(i, (pointer, _))| (*pointer, format!("p{i}")))
+                .collect(),
+            ret: c_sig.ret.clone(),
+            retptrs: c_sig.retptrs.clone(),
+        };
+
+        // The helper's signature doubles as part of the dedup key so that
+        // parameter and result types participate in it alongside the body.
+        let ret_ty = match &canon_sig.ret.scalar {
+            None | Some(Scalar::Void) => "void".to_string(),
+            Some(Scalar::OptionBool(_)) | Some(Scalar::ResultBool(..)) => "bool".to_string(),
+            Some(Scalar::Type(ty)) => {
+                let ty = *ty;
+                self.gen.type_name(&ty)
+            }
+        };
+        let mut params_text = String::new();
+        for (i, (_, ty)) in func.params.iter().enumerate() {
+            if i > 0 {
+                params_text.push_str(", ");
+            }
+            match self.flattened_option_param(ty) {
+                Some(payload) => {
+                    let payload = self.gen.type_name(&payload);
+                    uwrite!(params_text, "{payload} *maybe_p{i}");
+                }
+                None => {
+                    let name = self.gen.type_name(ty);
+                    let pointer = if is_arg_by_pointer(self.resolve, ty) {
+                        "*"
+                    } else {
+                        ""
+                    };
+                    uwrite!(params_text, "{name} {pointer}p{i}");
+                }
+            }
+        }
+        for (i, ty) in c_sig.ret.retptrs.iter().enumerate() {
+            if i > 0 || !func.params.is_empty() {
+                params_text.push_str(", ");
+            }
+            let name = self.gen.type_name(ty);
+            uwrite!(params_text, "{name} *{}", canon_sig.retptrs[i]);
+        }
+        if !params_text.is_empty() {
+            params_text.push_str(", ");
+        }
+        match wasm_sig.results.len() {
+            0 => params_text.push_str("void"),
+            1 => params_text.push_str(wasm_type(wasm_sig.results[0])),
+            _ => unimplemented!("multi-value return not supported"),
+        }
+        params_text.push_str(" (*target)(");
+        for (i, param) in wasm_sig.params.iter().enumerate() {
+            if i > 0 {
+                params_text.push_str(", ");
+            }
+            params_text.push_str(wasm_type(*param));
+        }
+        if wasm_sig.params.is_empty() {
+            params_text.push_str("void");
+        }
+        params_text.push_str(")");
+
+        let mut optional_adapters = String::from("");
+        if !self.gen.opts.no_sig_flattening {
+            for (i, (_, param)) in canon_sig.params.iter().enumerate() {
+                let ty = &func.params[i].1;
+                if self.flattened_option_param(ty).is_some() {
+                    let ty = self.gen.type_name(ty);
+                    uwrite!(
+                        optional_adapters,
+                        "{ty} {param};
+                        {param}.is_some = maybe_{param} != NULL;"
+                    );
+                    uwriteln!(
+                        optional_adapters,
+                        "if (maybe_{param}) {{
+                            {param}.val = *maybe_{param};
+                        }}",
+                    );
+                }
+            }
+        }
+
+        let mut f = FunctionBindgen::new(self, canon_sig, "target");
+        for (pointer, param) in f.sig.params.iter() {
+            f.locals.insert(&param).unwrap();
+            if *pointer {
+                f.params.push(format!("*{}", param));
+            } else {
+                f.params.push(param.clone());
+            }
+        }
+        for ptr in f.sig.retptrs.iter() {
+            f.locals.insert(ptr).unwrap();
+        }
+        f.src.push_str(&optional_adapters);
+        abi::call(
+            f.gen.resolve,
+            AbiVariant::GuestImport,
+            LiftLower::LowerArgsLiftResults,
+            func,
+            &mut f,
+            false,
+        );
+
+        let FunctionBindgen {
+            src,
+            import_return_pointer_area_size,
+            import_return_pointer_area_align,
+            cleanup_list_slots,
+            ..
+        } = f;
+
+        let mut body = String::new();
+        if import_return_pointer_area_size > 0 {
+            body.push_str(&format!(
+                "\
+                    __attribute__((__aligned__({import_return_pointer_area_align})))
+                    uint8_t ret_area[{import_return_pointer_area_size}];
+                ",
+            ));
+        }
+        if cleanup_list_slots > 0 {
+            body.push_str(&format!(
+                "\
+                    void *cleanup_list[{cleanup_list_slots}];
+                    size_t cleanup_len = 0;
+                ",
+            ));
+        }
+        body.push_str(&String::from(src));
+
+        let key = format!("{ret_ty}({params_text}) {{\n{body}}}");
+        if let Some(helper) = self.gen.adapter_helpers.get(&key) {
+            return helper.clone();
+        }
+        let helper = format!("__shared_adapter{}", self.gen.adapter_helpers.len());
+        self.src.c_adapters("\nstatic ");
+        self.src.c_adapters(&ret_ty);
+        self.src.c_adapters(" ");
+        self.src.c_adapters(&helper);
+        self.src.c_adapters("(");
+        self.src.c_adapters(&params_text);
+        self.src.c_adapters(") {\n");
+        self.src.c_adapters(&body);
+        self.src.c_adapters("}\n");
+        self.gen.adapter_helpers.insert(key, helper.clone());
+        helper
+    }
+
+    /// Checks that `func` has the shape required by a `--chunk` reader:
+    /// trailing unsigned offset and length parameters and a `list<u8>`
+    /// result. Returns the result type on success.
+    fn chunk_shape(&self, func: &Function) -> Option<Type> {
+        if func.params.len() < 2 {
+            return None;
+        }
+        for (_, ty) in func.params[func.params.len() - 2..].iter() {
+            match ty {
+                Type::U32 | Type::U64 => {}
+                _ => return None,
+            }
+        }
+        let mut results = func.results.iter_types();
+        let ret = *results.next()?;
+        if results.next().is_some() {
+            return None;
+        }
+        let id = match ret {
+            Type::Id(id) => dealias(self.resolve, id),
+            _ => return None,
+        };
+        match &self.resolve.types[id].kind {
+            TypeDefKind::List(Type::U8) => Some(ret),
+            _ => None,
+        }
+    }
+
+    /// Generates the `*_chunked` pull reader over the import wrapper for a
+    /// function tagged with `--chunk`.
+    ///
+    /// The reader repeatedly calls the wrapper for a window of at most
+    /// `chunk_size` bytes, hands each lifted chunk to the callback, and
+    /// frees it before pulling the next window, so peak linear memory for
+    /// the transfer is bounded by the chunk size. A short or empty read
+    /// ends the transfer normally; the callback returning `false`
+    /// abandons it and the reader returns `false`.
+    fn import_chunked_adapter(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
+        let ret = match self.chunk_shape(func) {
+            Some(ret) => ret,
+            None => {
+                eprintln!(
+                    "warning: chunked reader for `{}` requires trailing unsigned \
+                     offset/length parameters and a `list<u8>` result",
+                    func.name
+                );
+                return;
+            }
+        };
+        if self.gen.opts.arena {
+            eprintln!(
+                "warning: chunked reader for `{}` is not supported with `--arena` \
+                 since chunks cannot be freed individually",
+                func.name
+            );
+            return;
+        }
+
+        let name = self.c_func_name(interface_name, func);
+        let list_ty = self.gen.type_name(&ret);
+        let dealloc = self.gen.dealloc_fn();
+        let scalars = func.params.len() - 2;
+        let mut params = String::new();
+        let mut args = String::new();
+        for (pname, ty) in func.params[..scalars].iter() {
+            let pname = to_c_ident(pname);
+            match self.flattened_option_param(ty) {
+                Some(payload) => {
+                    let payload = self.gen.type_name(&payload);
+                    uwrite!(params, "{payload} *maybe_{pname}, ");
+                    uwrite!(args, "maybe_{pname}, ");
+                }
+                None => {
+                    let tyname = self.gen.type_name(ty);
+                    let pointer = if is_arg_by_pointer(self.resolve, ty) {
+                        "*"
+                    } else {
+                        ""
+                    };
+                    uwrite!(params, "{tyname} {pointer}{pname}, ");
+                    uwrite!(args, "{pname}, ");
+                }
+            }
+        }
+        let scalar_ty = |ty: &Type| match ty {
+            Type::U32 => "uint32_t",
+            _ => "uint64_t",
+        };
+        let off_name = to_c_ident(&func.params[scalars].0);
+        let off_ty = scalar_ty(&func.params[scalars].1);
+        let len_name = to_c_ident(&func.params[scalars + 1].0);
+        let len_ty = scalar_ty(&func.params[scalars + 1].1);
+
+        self.src.h_fns(&format!(
+            "\ntypedef bool (*{name}_chunk_fn_t)({list_ty} *chunk, void *userdata);\n\
+             extern bool {name}_chunked({params}{off_ty} {off_name}, {len_ty} {len_name}, \
+             {len_ty} chunk_size, {name}_chunk_fn_t callback, void *userdata);\n"
+        ));
+        self.src.c_adapters(&format!(
+            r#"
+                bool {name}_chunked({params}{off_ty} {off_name}, {len_ty} {len_name}, {len_ty} chunk_size, {name}_chunk_fn_t callback, void *userdata) {{
+                    while ({len_name} > 0) {{
+                        {len_ty} chunk_n = chunk_size == 0 || chunk_size > {len_name} ? {len_name} : chunk_size;
+                        {list_ty} chunk;
+                        {name}({args}{off_name}, chunk_n, &chunk);
+                        size_t chunk_got = chunk.len;
+                        bool chunk_more = chunk_got == 0 || callback(&chunk, userdata);
+                        if (chunk_got > 0) {{
+                            {dealloc}(chunk.ptr);
+                        }}
+                        if (!chunk_more) {{
+                            return false;
+                        }}
+                        if (chunk_got < (size_t) chunk_n) {{
+                            break;
+                        }}
+                        {off_name} += chunk_n;
+                        {len_name} -= chunk_n;
+                    }}
+                    return true;
+                }}
+            "#
+        ));
+    }
+
+    fn import(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
+        self.generate_payloads(interface_name, func);
+        self.docs(&func.docs, SourceType::HFns);
+        let sig = self.resolve.wasm_signature(AbiVariant::GuestImport, func);
+
+        self.src.c_fns("\n");
+
+        // In the private C file, print a function declaration which is the
+        // actual wasm import that we'll be calling, and this has the raw wasm
+        // signature.
+        uwriteln!(
+            self.src.c_fns,
+            "__attribute__((__import_module__(\"{}\"), __import_name__(\"{}\")))",
+            match interface_name {
+                Some(name) => self.resolve.name_world_key(name),
+                None => "$root".to_string(),
+            },
+            func.name
+        );
+        let name = self.c_func_name(interface_name, func);
+        let import_name = self.gen.names.tmp(&format!("__wasm_import_{name}",));
+        let perf_prologue = self
+            .gen
+            .opts
+            .instrument
+            .then(|| self.perf_prologue(&name));
+        self.src.c_fns("extern ");
+        match sig.results.len() {
+            0 => self.src.c_fns("void"),
+            1 => self.src.c_fns(wasm_type(sig.results[0])),
+            _ => unimplemented!("multi-value return not supported"),
+        }
+        self.src.c_fns(" ");
+        self.src.c_fns(&import_name);
+        self.src.c_fns("(");
+        for (i, param) in sig.params.iter().enumerate() {
+            if i > 0 {
+                self.src.c_fns(", ");
+            }
+            self.src.c_fns(wasm_type(*param));
+        }
+        if sig.params.len() == 0 {
+            self.src.c_fns("void");
+        }
+        self.src.c_fns(");\n");
+
+        // Print the public facing signature into the header, and since that's
+        // what we are defining also print it into the C file.
+        self.src.h_fns("extern ");
+        let c_sig = self.print_sig(interface_name, func, !self.gen.opts.no_sig_flattening);
+
+        // When deduplicating, the full lowering lives in a shared helper
+        // and the public wrapper just forwards to it along with the wasm
+        // import to call.
+        if self.gen.opts.dedup_adapters {
+            let helper = self.shared_adapter(func, &c_sig, &sig);
+            self.src.c_adapters("\n");
+            self.src.c_adapters(&c_sig.sig);
+            self.src.c_adapters(" {\n");
+            if let Some(prologue) = &perf_prologue {
+                self.src.c_adapters(prologue);
+            }
+            let mut args = Vec::new();
+            for (i, (_, param)) in c_sig.params.iter().enumerate() {
+                if self.flattened_option_param(&func.params[i].1).is_some() {
+                    args.push(format!("maybe_{param}"));
+                } else {
+                    args.push(param.clone());
+                }
+            }
+            args.extend(c_sig.retptrs.iter().cloned());
+            args.push(import_name.clone());
+            let call = format!("{helper}({})", args.join(", "));
+            match &c_sig.ret.scalar {
+                Some(Scalar::Void) => uwriteln!(self.src.c_adapters, "{call};"),
+                None => uwriteln!(self.src.c_adapters, "{call};"),
+                Some(_) => uwriteln!(self.src.c_adapters, "return {call};"),
+            }
+            self.src.c_adapters("}\n");
+
+            if self.gen.opts.views {
+                self.import_view_adapter(interface_name, func);
+            }
+            if self.gen.opts.cpp_helpers {
+                self.import_cpp_adapter(interface_name, func);
+            }
+            if self.gen.opts.chunk.iter().any(|c| c == &func.name) {
+                self.gen.chunked_funcs.insert(func.name.clone());
+                self.import_chunked_adapter(interface_name, func);
+            }
+            return;
+        }
+
+        self.src.c_adapters("\n");
+        self.src.c_adapters(&c_sig.sig);
+        self.src.c_adapters(" {\n");
+        if let Some(prologue) = &perf_prologue {
+            self.src.c_adapters(prologue);
+        }
+
+        // construct optional adapters from maybe pointers to real optional
+        // structs internally
+        let mut optional_adapters = String::from("");
+        if !self.gen.opts.no_sig_flattening {
+            for (i, (_, param)) in c_sig.params.iter().enumerate() {
+                let ty = &func.params[i].1;
+                if let Type::Id(id) = ty {
+                    if let TypeDefKind::Option(_) = &self.resolve.types[*id].kind {
+                        let ty = self.gen.type_name(ty);
+                        uwrite!(
+                            optional_adapters,
+                            "{ty} {param};
+                            {param}.is_some = maybe_{param} != NULL;"
+                        );
+                        uwriteln!(
+                            optional_adapters,
+                            "if (maybe_{param}) {{
+                                {param}.val = *maybe_{param};
+                            }}",
+                        );
+                    }
+                }
+            }
+        }
+
+        let mut f = FunctionBindgen::new(self, c_sig, &import_name);
+        for (pointer, param) in f.sig.params.iter() {
+            f.locals.insert(&param).unwrap();
+            if *pointer {
+                f.params.push(format!("*{}", param));
+            } else {
+                f.params.push(param.clone());
+            }
+        }
+        for ptr in f.sig.retptrs.iter() {
+            f.locals.insert(ptr).unwrap();
+        }
+        f.src.push_str(&optional_adapters);
+        abi::call(
+            f.gen.resolve,
+            AbiVariant::GuestImport,
+            LiftLower::LowerArgsLiftResults,
+            func,
+            &mut f,
+            false,
+        );
+
+        let FunctionBindgen {
+            src,
+            import_return_pointer_area_size,
+            import_return_pointer_area_align,
+            cleanup_list_slots,
+            ..
+        } = f;
+
+        if import_return_pointer_area_size > 0 {
+            self.src.c_adapters(&format!(
+                "\
+                    __attribute__((__aligned__({import_return_pointer_area_align})))
+                    uint8_t ret_area[{import_return_pointer_area_size}];
+                ",
+            ));
+        }
+
+        if cleanup_list_slots > 0 {
+            self.src.c_adapters(&format!(
+                "\
+                    void *cleanup_list[{cleanup_list_slots}];
+                    size_t cleanup_len = 0;
+                ",
+            ));
+        }
+
+        self.src.c_adapters(&String::from(src));
+        self.src.c_adapters("}\n");
+
+        if self.gen.opts.views {
+            self.import_view_adapter(interface_name, func);
+        }
+        if self.gen.opts.cpp_helpers {
+            self.import_cpp_adapter(interface_name, func);
+        }
+        if self.gen.opts.chunk.iter().any(|c| c == &func.name) {
+            self.gen.chunked_funcs.insert(func.name.clone());
+            self.import_chunked_adapter(interface_name, func);
+        }
+    }
+
+    /// Classifies `ty` as a parameter which can be accepted as a non-owning
+    /// view when the `views` option is enabled.
+    fn view_param(&self, ty: &Type) -> Option<ViewParam> {
+        match ty {
+            Type::String => Some(ViewParam::String),
+            Type::Id(id) => match &self.resolve.types[dealias(self.resolve, *id)].kind {
+                TypeDefKind::List(elem) => Some(ViewParam::List(*elem)),
+                TypeDefKind::Type(Type::String) => Some(ViewParam::String),
+                _ => None,
+            },
+            _ => None,
+        }
+    }
+
+    /// Generates a `*_view` variant of an import wrapper whose string and
+    /// list parameters are non-owning views over caller-provided buffers.
+    ///
+    /// The variant binds the borrowed pointers into owned-typed locals (the
+    /// layouts are identical) and forwards to the regular wrapper; since
+    /// imports never deallocate their arguments this is safe and copies
+    /// nothing.
+    fn import_view_adapter(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
+        if !func
+            .params
+            .iter()
+            .any(|(_, ty)| self.view_param(ty).is_some())
+        {
+            return;
+        }
+
+        let target = self.c_func_name(interface_name, func);
+        let name = format!("{target}_view");
+        self.gen.names.insert(&name).expect("duplicate symbols");
+        let snake = self.gen.world.to_snake_case();
+        let sig_flattening = !self.gen.opts.no_sig_flattening;
+
+        uwriteln!(
+            self.src.h_fns,
+            "\n// Variant of `{target}` which borrows its string and list arguments."
+        );
+        self.src.h_fns("extern ");
+        let start = self.src.h_fns.len();
+
+        let mut result_rets = false;
+        let mut result_rets_has_ok_type = false;
+        let ret = self.classify_ret(func, sig_flattening);
+        match &ret.scalar {
+            None | Some(Scalar::Void) => self.src.h_fns("void"),
+            Some(Scalar::OptionBool(_)) => self.src.h_fns("bool"),
+            Some(Scalar::ResultBool(ok, _err)) => {
+                result_rets = true;
+                result_rets_has_ok_type = ok.is_some();
+                self.src.h_fns("bool");
+            }
+            Some(Scalar::Type(ty)) => self.print_ty(SourceType::HFns, ty),
+        }
+        self.src.h_fns(" ");
+        self.src.h_fns(&name);
+        self.src.h_fns("(");
+
+        let mut bindings = String::new();
+        let mut args = Vec::new();
+        for (i, (pname, ty)) in func.params.iter().enumerate() {
+            if i > 0 {
+                self.src.h_fns(", ");
+            }
+            let pname = to_c_ident(pname);
+            match self.view_param(ty) {
+                Some(ViewParam::String) => {
+                    uwrite!(self.src.h_fns, "{snake}_string_view_t {pname}");
+                    let char_ty = self.gen.char_type();
+                    uwriteln!(bindings, "{snake}_string_t {pname}_owned;");
+                    uwriteln!(bindings, "{pname}_owned.ptr = ({char_ty} *) {pname}.ptr;");
+                    uwriteln!(bindings, "{pname}_owned.len = {pname}.len;");
+                    args.push(format!("&{pname}_owned"));
+                }
+                Some(ViewParam::List(elem)) => {
+                    let list_ty = self.gen.type_name(ty);
+                    let elem_ty = self.gen.type_name(&elem);
+                    uwrite!(
+                        self.src.h_fns,
+                        "const {elem_ty} *{pname}_ptr, size_t {pname}_len"
+                    );
+                    uwriteln!(bindings, "{list_ty} {pname}_owned;");
+                    uwriteln!(bindings, "{pname}_owned.ptr = ({elem_ty} *) {pname}_ptr;");
+                    uwriteln!(bindings, "{pname}_owned.len = {pname}_len;");
+                    args.push(format!("&{pname}_owned"));
+                }
+                None => {
+                    let pointer = is_arg_by_pointer(self.resolve, ty);
+                    let optional_type = if let Type::Id(id) = ty {
+                        if let TypeDefKind::Option(option_ty) = &self.resolve.types[*id].kind {
+                            if sig_flattening {
+                                Some(option_ty)
+                            } else {
+                                None
+                            }
+                        } else {
+                            None
+                        }
+                    } else {
+                        None
+                    };
+                    let (print_ty, print_name) = match optional_type {
+                        Some(option_ty) => (option_ty, format!("maybe_{pname}")),
+                        None => (ty, pname.clone()),
+                    };
+                    self.print_ty(SourceType::HFns, print_ty);
+                    self.src.h_fns(" ");
+                    if optional_type.is_none() && pointer {
+                        self.src.h_fns("*");
+                    }
+                    self.src.h_fns(&print_name);
+                    args.push(print_name);
+                }
+            }
+        }
+        let single_ret = ret.retptrs.len() == 1;
+        for (i, ty) in ret.retptrs.iter().enumerate() {
+            if i > 0 || func.params.len() > 0 {
+                self.src.h_fns(", ");
+            }
+            self.print_ty(SourceType::HFns, ty);
+            self.src.h_fns(" *");
+            let rname: String = if result_rets {
+                if i == 0 && result_rets_has_ok_type {
+                    "ret".into()
+                } else {
+                    "err".into()
+                }
+            } else if single_ret {
+                "ret".into()
+            } else {
+                format!("ret{}", i)
+            };
+            self.src.h_fns(&rname);
+            args.push(rname);
         }
-        if sig.params.len() == 0 {
-            self.src.c_fns("void");
+        if func.params.len() == 0 && ret.retptrs.len() == 0 {
+            self.src.h_fns("void");
         }
-        self.src.c_fns(");\n");
+        self.src.h_fns(")");
+        let sig = self.src.h_fns[start..].to_string();
+        self.src.h_fns(";\n");
 
-        // Print the public facing signature into the header, and since that's
-        // what we are defining also print it into the C file.
-        self.src.h_fns("extern ");
-        let c_sig = self.print_sig(interface_name, func, !self.gen.opts.no_sig_flattening);
         self.src.c_adapters("\n");
-        self.src.c_adapters(&c_sig.sig);
+        self.src.c_adapters(&sig);
         self.src.c_adapters(" {\n");
+        self.src.c_adapters(&bindings);
+        let call = format!("{target}({})", args.join(", "));
+        match &ret.scalar {
+            Some(Scalar::Void) => uwriteln!(self.src.c_adapters, "{call};"),
+            None => uwriteln!(self.src.c_adapters, "{call};"),
+            Some(_) => uwriteln!(self.src.c_adapters, "return {call};"),
+        }
+        self.src.c_adapters("}\n");
+    }
 
-        // construct optional adapters from maybe pointers to real optional
-        // structs internally
-        let mut optional_adapters = String::from("");
-        if !self.gen.opts.no_sig_flattening {
-            for (i, (_, param)) in c_sig.params.iter().enumerate() {
-                let ty = &func.params[i].1;
-                if let Type::Id(id) = ty {
-                    if let TypeDefKind::Option(_) = &self.resolve.types[*id].kind {
-                        let ty = self.gen.type_name(ty);
-                        uwrite!(
-                            optional_adapters,
-                            "{ty} {param};
-                            {param}.is_some = maybe_{param} != NULL;"
-                        );
-                        uwriteln!(
-                            optional_adapters,
-                            "if (maybe_{param}) {{
-                                {param}.val = *maybe_{param};
-                            }}",
-                        );
+    /// Records the `owned::` alias for the type `id`, which must have a
+    /// registered dtor function, and returns the alias name.
+    fn record_cpp_owned_alias(&mut self, id: TypeId) -> String {
+        let c_ty = self.gen.type_names[&id].clone();
+        let free = self.gen.dtor_funcs[&id].clone();
+        let alias = cpp_owned_alias(&c_ty).to_string();
+        self.gen
+            .cpp_owned_aliases
+            .insert(alias.clone(), (c_ty, free));
+        alias
+    }
+
+    /// Generates an inline C++ overload of an import wrapper into the
+    /// `{world}_helpers.hpp` header when the `cpp-helpers` option is
+    /// enabled.
+    ///
+    /// String and list parameters become `std::string_view`/`std::span`
+    /// views bound to the lowered pointer/length pairs without copying,
+    /// parameters whose type has a generated `*_free` function become
+    /// rvalue references to the owning `unique` wrapper (so the argument is
+    /// freed once the full expression ends), and a single owned result is
+    /// returned as an owning wrapper instead of through an out-pointer.
+    /// Functions where none of these apply get no overload; the C name is
+    /// visible from C++ already.
+    fn import_cpp_adapter(&mut self, interface_name: Option<&WorldKey>, func: &Function) {
+        let target = self.c_func_name(interface_name, func);
+        let snake = self.gen.world.to_snake_case();
+        let sig_flattening = !self.gen.opts.no_sig_flattening;
+        let string_view = cpp_string_view(self.gen.opts.string_encoding);
+
+        let ret = self.classify_ret(func, sig_flattening);
+        let mut interesting = false;
+        let mut params = Vec::new();
+        let mut bindings = String::new();
+        let mut args = Vec::new();
+        for (pname, ty) in func.params.iter() {
+            let pname = to_c_ident(pname);
+            let owned = match ty {
+                Type::Id(id) if !self.gen.opts.no_helpers => {
+                    let id = dealias(self.resolve, *id);
+                    self.gen.dtor_funcs.get(&id).map(|_| id)
+                }
+                _ => None,
+            };
+            match self.view_param(ty) {
+                Some(ViewParam::String) if string_view.is_some() => {
+                    let (view_ty, _) = string_view.unwrap();
+                    let char_ty = self.gen.char_type();
+                    params.push(format!("{view_ty} {pname}"));
+                    uwriteln!(bindings, "{snake}_string_t {pname}_c;");
+                    uwriteln!(bindings, "{pname}_c.ptr = ({char_ty} *) {pname}.data();");
+                    uwriteln!(bindings, "{pname}_c.len = {pname}.size();");
+                    args.push(format!("&{pname}_c"));
+                    interesting = true;
+                }
+                Some(ViewParam::List(elem)) => {
+                    let list_ty = self.gen.type_name(ty);
+                    let elem_ty = self.gen.type_name(&elem);
+                    params.push(format!("std::span<const {elem_ty}> {pname}"));
+                    uwriteln!(bindings, "{list_ty} {pname}_c;");
+                    uwriteln!(bindings, "{pname}_c.ptr = ({elem_ty} *) {pname}.data();");
+                    uwriteln!(bindings, "{pname}_c.len = {pname}.size();");
+                    args.push(format!("&{pname}_c"));
+                    interesting = true;
+                }
+                _ => {
+                    let pointer = is_arg_by_pointer(self.resolve, ty);
+                    // Flattened option parameters keep their `maybe_`
+                    // pointer shape, so the owned overload does not apply.
+                    let optional_type = if let Type::Id(id) = ty {
+                        if let TypeDefKind::Option(option_ty) = &self.resolve.types[*id].kind {
+                            if sig_flattening {
+                                Some(option_ty)
+                            } else {
+                                None
+                            }
+                        } else {
+                            None
+                        }
+                    } else {
+                        None
+                    };
+                    if optional_type.is_none() {
+                        if let Some(id) = owned {
+                            let alias = self.record_cpp_owned_alias(id);
+                            params.push(format!("owned::{alias} &&{pname}"));
+                            args.push(format!("{pname}.get()"));
+                            interesting = true;
+                            continue;
+                        }
+                    }
+                    match optional_type {
+                        Some(option_ty) => {
+                            let ty = self.gen.type_name(option_ty);
+                            params.push(format!("{ty} *maybe_{pname}"));
+                            args.push(format!("maybe_{pname}"));
+                        }
+                        None => {
+                            let tyname = self.gen.type_name(ty);
+                            let star = if pointer { "*" } else { "" };
+                            params.push(format!("{tyname} {star}{pname}"));
+                            args.push(pname);
+                        }
                     }
                 }
             }
         }
 
-        let mut f = FunctionBindgen::new(self, c_sig, &import_name);
-        for (pointer, param) in f.sig.params.iter() {
-            f.locals.insert(&param).unwrap();
-            if *pointer {
-                f.params.push(format!("*{}", param));
-            } else {
-                f.params.push(param.clone());
+        // A single non-scalar result whose type owns memory is returned as
+        // the owning wrapper rather than through an out-pointer.
+        let owned_ret = if ret.scalar.is_none() && ret.retptrs.len() == 1 {
+            let ty = &ret.retptrs[0];
+            match ty {
+                Type::String if !self.gen.opts.no_helpers && self.gen.needs_string => {
+                    Some(("string".to_string(), format!("{snake}_string_t")))
+                }
+                Type::Id(id) if !self.gen.opts.no_helpers => {
+                    let id = dealias(self.resolve, *id);
+                    if self.gen.dtor_funcs.contains_key(&id) {
+                        let alias = self.record_cpp_owned_alias(id);
+                        Some((format!("owned::{alias}"), self.gen.type_names[&id].clone()))
+                    } else {
+                        None
+                    }
+                }
+                _ => None,
             }
-        }
-        for ptr in f.sig.retptrs.iter() {
-            f.locals.insert(ptr).unwrap();
-        }
-        f.src.push_str(&optional_adapters);
-        abi::call(
-            f.gen.resolve,
-            AbiVariant::GuestImport,
-            LiftLower::LowerArgsLiftResults,
-            func,
-            &mut f,
-            false,
-        );
-
-        let FunctionBindgen {
-            src,
-            import_return_pointer_area_size,
-            import_return_pointer_area_align,
-            ..
-        } = f;
+        } else {
+            None
+        };
 
-        if import_return_pointer_area_size > 0 {
-            self.src.c_adapters(&format!(
-                "\
-                    __attribute__((__aligned__({import_return_pointer_area_align})))
-                    uint8_t ret_area[{import_return_pointer_area_size}];
-                ",
-            ));
+        let mut result_rets = false;
+        let mut result_rets_has_ok_type = false;
+        let ret_ty = match &ret.scalar {
+            None | Some(Scalar::Void) => "void".to_string(),
+            Some(Scalar::OptionBool(_)) => "bool".to_string(),
+            Some(Scalar::ResultBool(ok, _err)) => {
+                result_rets = true;
+                result_rets_has_ok_type = ok.is_some();
+                "bool".to_string()
+            }
+            Some(Scalar::Type(ty)) => self.gen.type_name(ty),
+        };
+        let (ret_ty, epilogue) = match &owned_ret {
+            Some((wrapper, c_ty)) => {
+                uwriteln!(bindings, "{c_ty} ret_c;");
+                args.push("&ret_c".to_string());
+                interesting = true;
+                (
+                    wrapper.clone(),
+                    format!("return {wrapper}(ret_c);"),
+                )
+            }
+            None => {
+                let single_ret = ret.retptrs.len() == 1;
+                for (i, ty) in ret.retptrs.iter().enumerate() {
+                    let rname: String = if result_rets {
+                        if i == 0 && result_rets_has_ok_type {
+                            "ret".into()
+                        } else {
+                            "err".into()
+                        }
+                    } else if single_ret {
+                        "ret".into()
+                    } else {
+                        format!("ret{}", i)
+                    };
+                    let tyname = self.gen.type_name(ty);
+                    params.push(format!("{tyname} *{rname}"));
+                    args.push(rname);
+                }
+                (ret_ty, String::new())
+            }
+        };
+        if !interesting {
+            return;
         }
 
-        self.src.c_adapters(&String::from(src));
-        self.src.c_adapters("}\n");
+        let out = &mut self.gen.cpp_adapters;
+        uwriteln!(out, "\n// RAII overload of `{target}`.");
+        uwriteln!(out, "inline {ret_ty} {target}({}) {{", params.join(", "));
+        out.push_str(&bindings);
+        let call = format!("::{target}({})", args.join(", "));
+        if !epilogue.is_empty() {
+            uwriteln!(out, "{call};");
+            uwriteln!(out, "{epilogue}");
+        } else {
+            match &ret.scalar {
+                None | Some(Scalar::Void) => uwriteln!(out, "{call};"),
+                Some(_) => uwriteln!(out, "return {call};"),
+            }
+        }
+        out.push_str("}\n");
     }
 
     fn export(&mut self, func: &Function, interface_name: Option<&WorldKey>) {
+        self.generate_payloads(interface_name, func);
         let sig = self.resolve.wasm_signature(AbiVariant::GuestExport, func);
 
         self.src.c_fns("\n");
@@ -1843,6 +4070,10 @@ impl InterfaceGenerator<'_> {
             f.gen.src.c_adapters("void");
         }
         f.gen.src.c_adapters(") {\n");
+        if f.gen.gen.opts.instrument {
+            let prologue = f.gen.perf_prologue(&name);
+            f.gen.src.c_adapters(&prologue);
+        }
 
         // Perform all lifting/lowering and append it to our src.
         abi::call(
@@ -1857,6 +4088,10 @@ impl InterfaceGenerator<'_> {
         self.src.c_adapters(&src);
         self.src.c_adapters("}\n");
 
+        // Results with nothing to free (no list or string anywhere in the
+        // type) get no `cabi_post_*` symbol at all, so the component
+        // encoder omits the post-return option and the host makes a single
+        // guest transition per call.
         if abi::guest_export_needs_post_return(self.resolve, func) {
             uwriteln!(
                 self.src.c_fns,
@@ -1864,6 +4099,23 @@ impl InterfaceGenerator<'_> {
             );
             uwrite!(self.src.c_fns, "void {import_name}_post_return(");
 
+            // In arena mode the lowered results (and any other lifted memory
+            // for this call) are reclaimed with a single arena reset instead
+            // of walking the values.
+            if self.gen.opts.arena {
+                for (i, result) in sig.results.iter().enumerate() {
+                    uwrite!(self.src.c_fns, "{} arg{i}", wasm_type(*result));
+                }
+                self.src.c_fns.push_str(") {\n");
+                for i in 0..sig.results.len() {
+                    uwriteln!(self.src.c_fns, "(void) arg{i};");
+                }
+                let snake = self.gen.world.to_snake_case();
+                uwriteln!(self.src.c_fns, "{snake}_arena_reset();");
+                self.src.c_fns("}\n");
+                return;
+            }
+
             let mut params = Vec::new();
             let mut c_sig = CSig {
                 name: String::from("INVALID"),
@@ -2026,6 +4278,26 @@ impl InterfaceGenerator<'_> {
         self.print_typedef_target(id);
     }
 
+    /// Like `finish_typedef_struct`, but marks the struct
+    /// `__attribute__((packed))` when the `packed` option is enabled. Used
+    /// for the discriminated-union types, whose canonical layout pads the
+    /// discriminant up to the payload alignment.
+    fn finish_packable_typedef_struct(&mut self, id: TypeId) {
+        self.src.h_defs("} ");
+        self.src.h_defs(self.packed_attr());
+        self.print_typedef_target(id);
+    }
+
+    /// Attribute emitted between the closing brace and the typedef name of a
+    /// packable struct definition.
+    fn packed_attr(&self) -> &'static str {
+        if self.gen.opts.packed {
+            "__attribute__((packed)) "
+        } else {
+            ""
+        }
+    }
+
     fn owner_namespace(&self, id: TypeId) -> String {
         owner_namespace(
             self.interface,
@@ -2119,11 +4391,6 @@ impl InterfaceGenerator<'_> {
     }
 }
 
-struct DroppableBorrow {
-    name: String,
-    ty: TypeId,
-}
-
 struct FunctionBindgen<'a, 'b> {
     gen: &'a mut InterfaceGenerator<'b>,
     locals: Ns,
@@ -2139,11 +4406,20 @@ struct FunctionBindgen<'a, 'b> {
     import_return_pointer_area_size: usize,
     import_return_pointer_area_align: usize,
 
-    /// Borrows observed during lifting an export, that will need to be dropped when the guest
-    /// function exits.
-    borrows: Vec<DroppableBorrow>,
+    /// Number of staging buffers lowered for packed-divergent list
+    /// arguments; they are released through a `cleanup_list` array declared
+    /// at the top of the import adapter.
+    cleanup_list_slots: usize,
 
-    /// Forward declarations for temporary storage of borrow copies.
+    /// Borrows observed during lifting an export, that will need to be dropped when the guest
+    /// function exits. One entry per resource type with the number of
+    /// borrow sites seen; each lifted handle is pushed into a scope-local
+    /// `borrow_slab{N}` array of that capacity and the whole slab is
+    /// drained through the type's drop function in a single loop on
+    /// return.
+    borrow_slabs: Vec<(TypeId, usize)>,
+
+    /// Forward declarations for the borrow slab arrays.
     borrow_decls: wit_bindgen_core::Source,
 }
 
@@ -2167,8 +4443,9 @@ impl<'a, 'b> FunctionBindgen<'a, 'b> {
             ret_store_cnt: 0,
             import_return_pointer_area_size: 0,
             import_return_pointer_area_align: 0,
+            cleanup_list_slots: 0,
             borrow_decls: Default::default(),
-            borrows: Vec::new(),
+            borrow_slabs: Vec::new(),
         }
     }
 
@@ -2267,7 +4544,18 @@ impl Bindgen for FunctionBindgen<'_, '_> {
     }
 
     fn is_list_canonical(&self, resolve: &Resolve, ty: &Type) -> bool {
-        resolve.all_bits_valid(ty)
+        // In addition to `all_bits_valid` elements, fixed-layout elements are
+        // transferred as one block: their generated C layout coincides with
+        // the canonical layout and the guest performs no validation, so the
+        // per-element code the non-canonical path would emit is a no-op.
+        (resolve.all_bits_valid(ty) || is_fixed_layout_type(resolve, ty))
+            && !self.gen.gen.packed_layout_divergent(resolve, ty)
+    }
+
+    fn is_wide_copy(&self, resolve: &Resolve, ty: &Type) -> bool {
+        // The generated C layout for fixed-layout aggregates coincides with
+        // the canonical layout, so they transfer as a single `memcpy`.
+        is_fixed_layout_type(resolve, ty) && !self.gen.gen.packed_layout_divergent(resolve, ty)
     }
 
     fn emit(
@@ -2401,16 +4689,36 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                             // kind we'll need to drop when the exported function is returning.
                             let ty = dealias(self.gen.resolve, *id);
 
-                            let name = self.locals.tmp("borrow");
-                            uwriteln!(self.borrow_decls, "int32_t {name} = 0;");
-                            uwriteln!(self.src, "{name} = {op};");
-
-                            self.borrows.push(DroppableBorrow { name, ty });
+                            let slab = match
+                                self.borrow_slabs.iter().position(|(t, _)| *t == ty)
+                            {
+                                Some(slab) => slab,
+                                None => {
+                                    self.borrow_slabs.push((ty, 0));
+                                    self.borrow_slabs.len() - 1
+                                }
+                            };
+                            self.borrow_slabs[slab].1 += 1;
+                            uwriteln!(
+                                self.src,
+                                "borrow_slab{slab}[borrow_slab{slab}_len++] = {op};"
+                            );
                         }
                     }
                 }
             },
 
+            Instruction::FutureLower { .. } | Instruction::StreamLower { .. } => {
+                let op = &operands[0];
+                results.push(format!("({op}).__handle"))
+            }
+
+            Instruction::FutureLift { ty, .. } | Instruction::StreamLift { ty, .. } => {
+                let op = &operands[0];
+                let name = self.gen.gen.type_name(&Type::Id(*ty));
+                results.push(format!("({name}) {{ {op} }}"));
+            }
+
             // TODO: checked
             Instruction::FlagsLower { flags, ty, .. } => match flags_repr(flags) {
                 Int::U8 | Int::U16 | Int::U32 => {
@@ -2477,16 +4785,23 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     uwriteln!(self.src, "case {}: {{", i);
                     if let Some(ty) = case.ty.as_ref() {
                         let ty = self.gen.gen.type_name(ty);
-                        uwrite!(
-                            self.src,
-                            "const {} *{} = &({}).val",
-                            ty,
-                            payload,
-                            operands[0],
-                        );
-                        self.src.push_str(".");
-                        self.src.push_str(&to_c_ident(&case.name));
-                        self.src.push_str(";\n");
+                        let case = to_c_ident(&case.name);
+                        let op0 = &operands[0];
+                        if self.gen.gen.opts.packed {
+                            // Packed members may be unaligned, so hand the
+                            // block a pointer to an aligned copy instead of
+                            // pointing into the packed object.
+                            uwriteln!(
+                                self.src,
+                                "{ty} {payload}_copy = ({op0}).val.{case};\n\
+                                 const {ty} *{payload} = &{payload}_copy;"
+                            );
+                        } else {
+                            uwriteln!(
+                                self.src,
+                                "const {ty} *{payload} = &({op0}).val.{case};"
+                            );
+                        }
                     }
                     self.src.push_str(&block);
 
@@ -2553,7 +4868,14 @@ impl Bindgen for FunctionBindgen<'_, '_> {
 
                 let op0 = &operands[0];
                 let ty = self.gen.gen.type_name(payload);
-                let bind_some = format!("const {ty} *{some_payload} = &({op0}).val;");
+                let bind_some = if self.gen.gen.opts.packed {
+                    format!(
+                        "{ty} {some_payload}_copy = ({op0}).val;\n\
+                         const {ty} *{some_payload} = &{some_payload}_copy;"
+                    )
+                } else {
+                    format!("const {ty} *{some_payload} = &({op0}).val;")
+                };
 
                 uwrite!(
                     self.src,
@@ -2627,15 +4949,30 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 }
 
                 let op0 = &operands[0];
+                let packed = self.gen.gen.opts.packed;
                 let bind_ok = if let Some(ok) = result.ok.as_ref() {
                     let ok_ty = self.gen.gen.type_name(ok);
-                    format!("const {ok_ty} *{ok_payload} = &({op0}).val.ok;")
+                    if packed {
+                        format!(
+                            "{ok_ty} {ok_payload}_copy = ({op0}).val.ok;\n\
+                             const {ok_ty} *{ok_payload} = &{ok_payload}_copy;"
+                        )
+                    } else {
+                        format!("const {ok_ty} *{ok_payload} = &({op0}).val.ok;")
+                    }
                 } else {
                     String::new()
                 };
                 let bind_err = if let Some(err) = result.err.as_ref() {
                     let err_ty = self.gen.gen.type_name(err);
-                    format!("const {err_ty} *{err_payload} = &({op0}).val.err;")
+                    if packed {
+                        format!(
+                            "{err_ty} {err_payload}_copy = ({op0}).val.err;\n\
+                             const {err_ty} *{err_payload} = &{err_payload}_copy;"
+                        )
+                    } else {
+                        format!("const {err_ty} *{err_payload} = &({op0}).val.err;")
+                    }
                 } else {
                     String::new()
                 };
@@ -2731,22 +5068,112 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 ));
             }
 
-            Instruction::ListLower { .. } => {
-                let _body = self.blocks.pop().unwrap();
-                results.push(format!("(uint8_t *) ({}).ptr", operands[0]));
-                results.push(format!("({}).len", operands[0]));
+            Instruction::ListLower { element, realloc } => {
+                let (body, _) = self.blocks.pop().unwrap();
+                if self
+                    .gen
+                    .gen
+                    .packed_layout_divergent(self.gen.resolve, element)
+                {
+                    // The packed element structs no longer match the
+                    // canonical stride, so lower each element into a
+                    // canonical staging buffer.
+                    let op = operands[0].clone();
+                    let size = self.gen.gen.sizes.size(element).size_wasm32();
+                    let align = self.gen.gen.sizes.align(element).align_wasm32();
+                    let elem_name = self.gen.gen.type_name(element);
+                    let len = self.locals.tmp("len");
+                    let result = self.locals.tmp("result");
+                    let i = self.locals.tmp("i");
+                    uwriteln!(self.src, "size_t {len} = ({op}).len;");
+                    match realloc {
+                        None => {
+                            // The callee does not take ownership of the
+                            // staging buffer, so release it once the call
+                            // returns.
+                            uwriteln!(
+                                self.src,
+                                "uint8_t *{result} = (uint8_t *) malloc({len} * {size});"
+                            );
+                            uwriteln!(self.src, "cleanup_list[cleanup_len++] = {result};");
+                            self.cleanup_list_slots += 1;
+                        }
+                        Some(_) => {
+                            uwriteln!(
+                                self.src,
+                                "uint8_t *{result} = (uint8_t *) cabi_realloc(NULL, 0, \
+                                 {align}, {len} * {size});"
+                            );
+                        }
+                    }
+                    uwriteln!(self.src, "for (size_t {i} = 0; {i} < {len}; {i}++) {{");
+                    uwriteln!(self.src, "{elem_name} e = ({op}).ptr[{i}];");
+                    uwriteln!(self.src, "uint8_t *base = {result} + {i} * {size};");
+                    self.src.push_str(&body);
+                    uwriteln!(self.src, "}}");
+                    if realloc.is_some() {
+                        // Ownership of the element contents moved into the
+                        // staging buffer; only the packed array itself is
+                        // left to free.
+                        uwriteln!(
+                            self.src,
+                            "{}((void *) ({op}).ptr);",
+                            self.gen.gen.dealloc_fn()
+                        );
+                    }
+                    results.push(result);
+                    results.push(len);
+                } else {
+                    results.push(format!("(uint8_t *) ({}).ptr", operands[0]));
+                    results.push(format!("({}).len", operands[0]));
+                }
             }
 
             Instruction::ListLift { element, ty, .. } => {
                 self.assert_no_droppable_borrows("list", &Type::Id(*ty));
 
-                let _body = self.blocks.pop().unwrap();
+                let (body, block_results) = self.blocks.pop().unwrap();
                 let list_name = self.gen.gen.type_name(&Type::Id(*ty));
                 let elem_name = self.gen.gen.type_name(element);
-                results.push(format!(
-                    "({}) {{ ({}*)({}), ({}) }}",
-                    list_name, elem_name, operands[0], operands[1]
-                ));
+                if self
+                    .gen
+                    .gen
+                    .packed_layout_divergent(self.gen.resolve, element)
+                {
+                    // Lift each element out of the canonical buffer into a
+                    // packed array, then release the canonical buffer the
+                    // way a block transfer would have handed it off.
+                    assert_eq!(block_results.len(), 1);
+                    let op = operands[0].clone();
+                    let size = self.gen.gen.sizes.size(element).size_wasm32();
+                    let align = self.gen.gen.sizes.align(element).align_wasm32();
+                    let len = self.locals.tmp("len");
+                    let result = self.locals.tmp("result");
+                    let i = self.locals.tmp("i");
+                    uwriteln!(self.src, "size_t {len} = {};", operands[1]);
+                    uwriteln!(
+                        self.src,
+                        "{elem_name} *{result} = {len} > 0 \
+                         ? ({elem_name} *) cabi_realloc(NULL, 0, {align}, \
+                         {len} * sizeof({elem_name})) : NULL;"
+                    );
+                    uwriteln!(self.src, "for (size_t {i} = 0; {i} < {len}; {i}++) {{");
+                    uwriteln!(self.src, "uint8_t *base = ({op}) + {i} * {size};");
+                    self.src.push_str(&body);
+                    uwriteln!(self.src, "{result}[{i}] = {};", block_results[0]);
+                    uwriteln!(self.src, "}}");
+                    uwriteln!(
+                        self.src,
+                        "if ({len} > 0) {{\n{}((void *) ({op}));\n}}",
+                        self.gen.gen.dealloc_fn()
+                    );
+                    results.push(format!("({list_name}) {{ {result}, {len} }}"));
+                } else {
+                    results.push(format!(
+                        "({}) {{ ({}*)({}), ({}) }}",
+                        list_name, elem_name, operands[0], operands[1]
+                    ));
+                }
             }
             Instruction::IterElem { .. } => results.push("e".to_string()),
             Instruction::IterBasePointer => results.push("base".to_string()),
@@ -2790,8 +5217,25 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     } else {
                         if !self.gen.in_import {
                             if let Type::Id(id) = ty {
-                                if let TypeDefKind::Option(_) = &self.gen.resolve.types[*id].kind {
-                                    uwrite!(args, "{op}.is_some ? &({op}.val) : NULL");
+                                if let TypeDefKind::Option(t) = &self.gen.resolve.types[*id].kind {
+                                    if self.gen.gen.opts.packed {
+                                        // Packed members may be unaligned;
+                                        // give the callee a pointer to an
+                                        // aligned copy of the payload.
+                                        let t = *t;
+                                        let payload_ty = self.gen.gen.type_name(&t);
+                                        let name = self.locals.tmp("maybe");
+                                        uwriteln!(
+                                            self.src,
+                                            "{payload_ty} {name};\n\
+                                             if ({op}.is_some) {{\n\
+                                             {name} = {op}.val;\n\
+                                             }}"
+                                        );
+                                        uwrite!(args, "{op}.is_some ? &{name} : NULL");
+                                    } else {
+                                        uwrite!(args, "{op}.is_some ? &({op}.val) : NULL");
+                                    }
                                     continue;
                                 }
                             }
@@ -2913,7 +5357,20 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     }
                 }
             }
-            Instruction::Return { .. } if self.gen.in_import => match self.sig.ret.scalar {
+            Instruction::Return { .. } if self.gen.in_import => {
+                if self.cleanup_list_slots > 0 {
+                    // Release the canonical staging buffers lowered for
+                    // packed-divergent list arguments; the call has
+                    // completed, so the host no longer reads them.
+                    let i = self.locals.tmp("i");
+                    uwriteln!(
+                        self.src,
+                        "for (size_t {i} = 0; {i} < cleanup_len; {i}++) {{\n\
+                         free(cleanup_list[{i}]);\n\
+                         }}"
+                    );
+                }
+                match self.sig.ret.scalar {
                 None => {
                     for op in operands.iter() {
                         self.store_in_retptr(op);
@@ -2967,17 +5424,30 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     );
                     assert_eq!(self.ret_store_cnt, self.sig.retptrs.len());
                 }
-            },
+            }}
             Instruction::Return { amt, .. } => {
-                // Emit all temporary borrow decls
+                // Declare the borrow slabs now that every borrow site has
+                // been counted, and prepend them to the function body.
+                for (slab, (_, count)) in self.borrow_slabs.iter().enumerate() {
+                    uwriteln!(self.borrow_decls, "int32_t borrow_slab{slab}[{count}];");
+                    uwriteln!(self.borrow_decls, "size_t borrow_slab{slab}_len = 0;");
+                }
                 let src = std::mem::replace(&mut self.src, std::mem::take(&mut self.borrow_decls));
                 self.src.append_src(&src);
 
-                for DroppableBorrow { name, ty } in self.borrows.iter() {
+                // Drain each slab in one loop; the canonical ABI has no
+                // batched drop, so this is still one `resource-drop` call
+                // per handle, but the handles are released from a dense
+                // array instead of a guarded statement per borrow site.
+                for (slab, (ty, _)) in self.borrow_slabs.iter().enumerate() {
                     let drop_fn = self.gen.gen.resources[ty].drop_fn.as_str();
-                    uwriteln!(self.src, "if ({name} != 0) {{");
-                    uwriteln!(self.src, "  {drop_fn}({name});");
-                    uwriteln!(self.src, "}}");
+                    let i = self.locals.tmp("i");
+                    uwriteln!(
+                        self.src,
+                        "for (size_t {i} = 0; {i} < borrow_slab{slab}_len; {i}++) {{\n\
+                         {drop_fn}(borrow_slab{slab}[{i}]);\n\
+                         }}"
+                    );
                 }
 
                 assert!(*amt <= 1);
@@ -3016,12 +5486,47 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 self.load_ext("int16_t", *offset, operands, results)
             }
 
+            Instruction::WideStore { ty, offset } => {
+                self.gen.gen.needs_memcpy = true;
+                let name = self.gen.gen.type_name(ty);
+                let size = self.gen.gen.sizes.size(ty).size_wasm32();
+                let tmp = self.locals.tmp("tmp");
+                uwriteln!(self.src, "{name} {tmp} = {};", operands[0]);
+                uwriteln!(
+                    self.src,
+                    "memcpy((void *) (({}) + {offset}), &{tmp}, {size});",
+                    operands[1]
+                );
+            }
+            Instruction::WideLoad { ty, offset } => {
+                self.gen.gen.needs_memcpy = true;
+                let name = self.gen.gen.type_name(ty);
+                let size = self.gen.gen.sizes.size(ty).size_wasm32();
+                let tmp = self.locals.tmp("tmp");
+                uwriteln!(self.src, "{name} {tmp};");
+                uwriteln!(
+                    self.src,
+                    "memcpy(&{tmp}, (void *) (({}) + {offset}), {size});",
+                    operands[0]
+                );
+                results.push(tmp);
+            }
+
             Instruction::GuestDeallocate { .. } => {
-                uwriteln!(self.src, "free({});", operands[0]);
+                uwriteln!(self.src, "{}({});", self.gen.gen.dealloc_fn(), operands[0]);
             }
             Instruction::GuestDeallocateString => {
-                uwriteln!(self.src, "if (({}) > 0) {{", operands[1]);
-                uwriteln!(self.src, "free({});", operands[0]);
+                let guard = if self.gen.gen.opts.static_strings {
+                    format!(
+                        " && !{}_is_static_data({})",
+                        self.gen.gen.world.to_snake_case(),
+                        operands[0]
+                    )
+                } else {
+                    String::new()
+                };
+                uwriteln!(self.src, "if (({}) > 0{guard}) {{", operands[1]);
+                uwriteln!(self.src, "{}({});", self.gen.gen.dealloc_fn(), operands[0]);
                 uwriteln!(self.src, "}}");
             }
             Instruction::GuestDeallocateVariant { blocks } => {
@@ -3047,14 +5552,18 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 uwriteln!(self.src, "if ({len} > 0) {{");
                 let ptr = self.locals.tmp("ptr");
                 uwriteln!(self.src, "uint8_t *{ptr} = {};", operands[0]);
-                let i = self.locals.tmp("i");
-                uwriteln!(self.src, "for (size_t {i} = 0; {i} < {len}; {i}++) {{");
-                let size = self.gen.gen.sizes.size(element).size_wasm32();
-                uwriteln!(self.src, "uint8_t *base = {ptr} + {i} * {size};");
-                uwriteln!(self.src, "(void) base;");
-                uwrite!(self.src, "{body}");
-                uwriteln!(self.src, "}}");
-                uwriteln!(self.src, "free({ptr});");
+                // Elements without anything to deallocate produce an empty
+                // block, in which case only the backing buffer is freed.
+                if !body.trim().is_empty() {
+                    let i = self.locals.tmp("i");
+                    uwriteln!(self.src, "for (size_t {i} = 0; {i} < {len}; {i}++) {{");
+                    let size = self.gen.gen.sizes.size(element).size_wasm32();
+                    uwriteln!(self.src, "uint8_t *base = {ptr} + {i} * {size};");
+                    uwriteln!(self.src, "(void) base;");
+                    uwrite!(self.src, "{body}");
+                    uwriteln!(self.src, "}}");
+                }
+                uwriteln!(self.src, "{}({ptr});", self.gen.gen.dealloc_fn());
                 uwriteln!(self.src, "}}");
             }
 
@@ -3168,8 +5677,8 @@ pub fn is_arg_by_pointer(resolve: &Resolve, ty: &Type) -> bool {
             TypeDefKind::Flags(_) => false,
             TypeDefKind::Handle(_) => false,
             TypeDefKind::Tuple(_) | TypeDefKind::Record(_) | TypeDefKind::List(_) => true,
-            TypeDefKind::Future(_) => todo!("is_arg_by_pointer for future"),
-            TypeDefKind::Stream(_) => todo!("is_arg_by_pointer for stream"),
+            TypeDefKind::Future(_) => false,
+            TypeDefKind::Stream(_) => false,
             TypeDefKind::ErrorContext => todo!("is_arg_by_pointer for error-context"),
             TypeDefKind::Resource => todo!("is_arg_by_pointer for resource"),
             TypeDefKind::Unknown => unreachable!(),
@@ -3179,6 +5688,75 @@ pub fn is_arg_by_pointer(resolve: &Resolve, ty: &Type) -> bool {
     }
 }
 
+/// Adds `ty` and every type its `*_free` helper recurses into to the set
+/// of types whose dtor helpers are reachable from user code.
+fn add_dtor_live(resolve: &Resolve, live: &mut HashSet<TypeId>, ty: &Type) {
+    let id = match ty {
+        Type::Id(id) => *id,
+        _ => return,
+    };
+    if !live.insert(id) {
+        return;
+    }
+    match &resolve.types[id].kind {
+        TypeDefKind::Type(t) => add_dtor_live(resolve, live, t),
+        TypeDefKind::Record(r) => {
+            for field in r.fields.iter() {
+                add_dtor_live(resolve, live, &field.ty);
+            }
+        }
+        TypeDefKind::Tuple(t) => {
+            for ty in t.types.iter() {
+                add_dtor_live(resolve, live, ty);
+            }
+        }
+        TypeDefKind::Variant(v) => {
+            for case in v.cases.iter() {
+                if let Some(ty) = &case.ty {
+                    add_dtor_live(resolve, live, ty);
+                }
+            }
+        }
+        TypeDefKind::Option(t) => add_dtor_live(resolve, live, t),
+        TypeDefKind::Result(r) => {
+            if let Some(ok) = &r.ok {
+                add_dtor_live(resolve, live, ok);
+            }
+            if let Some(err) = &r.err {
+                add_dtor_live(resolve, live, err);
+            }
+        }
+        TypeDefKind::List(t) => add_dtor_live(resolve, live, t),
+        TypeDefKind::Handle(Handle::Borrow(id) | Handle::Own(id)) => {
+            add_dtor_live(resolve, live, &Type::Id(*id));
+        }
+        TypeDefKind::Flags(_)
+        | TypeDefKind::Enum(_)
+        | TypeDefKind::Resource
+        | TypeDefKind::Future(_)
+        | TypeDefKind::Stream(_)
+        | TypeDefKind::ErrorContext
+        | TypeDefKind::Unknown => {}
+    }
+}
+
+/// Returns the C++ view type and character type used for strings of the
+/// given encoding, or `None` when no standard view type matches (the compact
+/// encoding tags its length field, so no contiguous view exists).
+fn cpp_string_view(encoding: StringEncoding) -> Option<(&'static str, &'static str)> {
+    match encoding {
+        StringEncoding::UTF8 => Some(("std::string_view", "char")),
+        StringEncoding::UTF16 => Some(("std::u16string_view", "char16_t")),
+        StringEncoding::CompactUTF16 => None,
+    }
+}
+
+/// Name of the `owned::` alias generated for the C type `name` in the C++
+/// helpers header.
+fn cpp_owned_alias(name: &str) -> &str {
+    name.strip_suffix("_t").unwrap_or(name)
+}
+
 pub fn to_c_ident(name: &str) -> String {
     match name {
         // Escape C and C++ keywords.
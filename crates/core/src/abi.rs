@@ -148,6 +148,18 @@ def_instruction! {
         /// Like `I32Store` or `I64Store`, but for storing array length values.
         LengthStore { offset: i32 } : [2] => [0],
 
+        /// Pops a pointer from the stack and then a value of the aggregate
+        /// type `ty`. Stores the value as a single contiguous block at the
+        /// pointer specified plus the constant `offset`, fusing the
+        /// field-by-field store sequence that would otherwise be generated.
+        /// Only emitted for types the backend accepted through
+        /// [`Bindgen::is_wide_copy`].
+        WideStore { ty: &'a Type, offset: i32 } : [2] => [0],
+        /// Pops a pointer from the stack and loads a value of the aggregate
+        /// type `ty` from it as a single contiguous block, using the
+        /// specified constant offset. The inverse of `WideStore`.
+        WideLoad { ty: &'a Type, offset: i32 } : [1] => [1],
+
         // Scalar lifting/lowering
 
         /// Converts an interface type `char` value to a 32-bit integer
@@ -728,6 +740,19 @@ pub trait Bindgen {
     /// "canonical" form for lists. This dictates whether the `ListCanonLower`
     /// and `ListCanonLift` instructions are used or not.
     fn is_list_canonical(&self, resolve: &Resolve, element: &Type) -> bool;
+
+    /// Returns whether record or tuple values of the given type may be copied
+    /// to and from linear memory as a single contiguous block rather than
+    /// field-by-field.
+    ///
+    /// Backends whose in-memory representation of `ty` matches its canonical
+    /// ABI layout can opt in here to receive the fused `WideStore` and
+    /// `WideLoad` instructions, which they can map to a `memcpy` or a wide
+    /// move, in place of the scalar load/store sequence generated by default.
+    fn is_wide_copy(&self, resolve: &Resolve, ty: &Type) -> bool {
+        let _ = (resolve, ty);
+        false
+    }
 }
 
 /// Generates an abstract sequence of instructions which represents this
@@ -813,7 +838,12 @@ pub fn post_return(resolve: &Resolve, func: &Function, bindgen: &mut impl Bindge
 /// be generated in guest code.
 ///
 /// This is used when the return value contains a memory allocation such as
-/// a list or a string primarily.
+/// a list or a string primarily. The check is precise rather than
+/// conservative: a result type only counts when it transitively owns an
+/// allocation, so exports returning purely scalar data (numbers, flags,
+/// enums, handles, and aggregates thereof) generate no post-return
+/// function at all and the host skips the second guest transition for
+/// them entirely.
 pub fn guest_export_needs_post_return(resolve: &Resolve, func: &Function) -> bool {
     func.results
         .iter_types()
@@ -894,6 +924,15 @@ impl<'a, B: Bindgen> Generator<'a, B> {
     }
 
     fn call(&mut self, func: &Function) {
+        // Mirror of the canonical ABI's fixed flattening limit. Together
+        // with `sig.indirect_params`/`sig.retptr` (computed by
+        // `Resolve::wasm_signature` under the same rules: at most 16 flat
+        // parameters and 1 flat result) this decides when values spill
+        // through linear memory. The limits are part of the component
+        // model's lifting contract rather than a generator choice, so they
+        // cannot be raised here even on engines with multivalue support:
+        // the host flattens with the same thresholds, and a signature that
+        // disagrees simply fails to lift.
         const MAX_FLAT_PARAMS: usize = 16;
 
         let sig = self.resolve.wasm_signature(self.variant, func);
@@ -1660,6 +1699,20 @@ impl<'a, B: Bindgen> Generator<'a, B> {
     fn write_to_memory(&mut self, ty: &Type, addr: B::Operand, offset: i32) {
         use Instruction::*;
 
+        // Aggregates the backend can copy as one block skip the per-field
+        // decomposition entirely and store the value with one instruction.
+        if let Type::Id(id) = ty {
+            if matches!(
+                &self.resolve.types[*id].kind,
+                TypeDefKind::Record(_) | TypeDefKind::Tuple(_)
+            ) && self.bindgen.is_wide_copy(self.resolve, ty)
+            {
+                self.stack.push(addr);
+                self.emit(&WideStore { ty, offset });
+                return;
+            }
+        }
+
         match *ty {
             // Builtin types need different flavors of storage instructions
             // depending on the size of the value written.
@@ -1857,6 +1910,18 @@ impl<'a, B: Bindgen> Generator<'a, B> {
     fn read_from_memory(&mut self, ty: &Type, addr: B::Operand, offset: i32) {
         use Instruction::*;
 
+        if let Type::Id(id) = ty {
+            if matches!(
+                &self.resolve.types[*id].kind,
+                TypeDefKind::Record(_) | TypeDefKind::Tuple(_)
+            ) && self.bindgen.is_wide_copy(self.resolve, ty)
+            {
+                self.stack.push(addr);
+                self.emit(&WideLoad { ty, offset });
+                return;
+            }
+        }
+
         match *ty {
             Type::Bool => self.emit_and_lift(ty, addr, &I32Load8U { offset }),
             Type::U8 => self.emit_and_lift(ty, addr, &I32Load8U { offset }),
@@ -2135,8 +2200,9 @@ impl<'a, B: Bindgen> Generator<'a, B> {
 
                 TypeDefKind::Enum(_) => {}
 
-                TypeDefKind::Future(_) => todo!("read future from memory"),
-                TypeDefKind::Stream(_) => todo!("read stream from memory"),
+                // Future and stream handles own no linear memory.
+                TypeDefKind::Future(_) => {}
+                TypeDefKind::Stream(_) => {}
                 TypeDefKind::ErrorContext => todo!("read error-context from memory"),
                 TypeDefKind::Unknown => unreachable!(),
             },
@@ -21,6 +21,19 @@ pub enum Direction {
 }
 
 pub trait WorldGenerator {
+    /// Drives generation of a whole world: imported interfaces first, then
+    /// world-level types and functions, then exported interfaces, then
+    /// `finish`.
+    ///
+    /// Interfaces are deliberately visited serially and in a fixed order.
+    /// Each visit mutates generator-wide state — type name registration,
+    /// helper-function deduplication, resource tables — and later visits
+    /// depend on what earlier ones recorded (see the note below about an
+    /// interface that is both imported and exported). Generating independent
+    /// interfaces concurrently would require every backend to keep
+    /// per-interface state shared-nothing until `finish`, which none of them
+    /// do today; parallelism for large builds is instead available across
+    /// worlds/invocations, which share nothing.
     fn generate(&mut self, resolve: &Resolve, id: WorldId, files: &mut Files) -> Result<()> {
         let world = &resolve.worlds[id];
         self.preprocess(resolve, id);
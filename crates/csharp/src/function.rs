@@ -725,7 +725,12 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                         let ptr: String = self.locals.tmp("listPtr");
                         let handle: String = self.locals.tmp("gcHandle");
 
-                        if !self.is_block && self.parameter_type == ParameterType::Span {
+                        if !self.is_block
+                            && matches!(
+                                self.parameter_type,
+                                ParameterType::Span | ParameterType::ReadOnlySpan
+                            )
+                        {
                             self.fixed_statments.push(Fixed {
                                 item_to_pin: list.clone(),
                                 ptr_name: ptr.clone(),
@@ -776,19 +781,39 @@ impl Bindgen for FunctionBindgen<'_, '_> {
 
             Instruction::ListCanonLift { element, .. } => {
                 let (_, ty) = list_element_info(element);
-                let array = self.locals.tmp("array");
                 let address = &operands[0];
                 let length = &operands[1];
 
-                uwrite!(
-                    self.src,
-                    "
-                    var {array} = new {ty}[{length}];
-                    new Span<{ty}>((void*)({address}), {length}).CopyTo(new Span<{ty}>({array}));
-                    "
-                );
+                if !self.is_block
+                    && self.interface_gen.direction == Direction::Export
+                    && self.parameter_type == ParameterType::Span
+                {
+                    // The exported signature receives this list as a
+                    // `Span<T>`, so wrap linear memory directly rather than
+                    // copying the elements into a managed array.
+                    let span = self.locals.tmp("span");
 
-                results.push(array);
+                    uwrite!(
+                        self.src,
+                        "
+                        var {span} = new Span<{ty}>((void*)({address}), (int)({length}));
+                        "
+                    );
+
+                    results.push(span);
+                } else {
+                    let array = self.locals.tmp("array");
+
+                    uwrite!(
+                        self.src,
+                        "
+                        var {array} = new {ty}[{length}];
+                        new Span<{ty}>((void*)({address}), {length}).CopyTo(new Span<{ty}>({array}));
+                        "
+                    );
+
+                    results.push(array);
+                }
             }
 
             Instruction::StringLower { realloc } => {
@@ -1093,6 +1118,10 @@ impl Bindgen for FunctionBindgen<'_, '_> {
 
             Instruction::Malloc { .. } => unimplemented!(),
 
+            // Only generated for backends that opt in via
+            // `Bindgen::is_wide_copy`.
+            Instruction::WideStore { .. } | Instruction::WideLoad { .. } => unreachable!(),
+
             Instruction::GuestDeallocate { .. } => {
                 // the original alloc here comes from cabi_realloc implementation (wasi-libc in .net)
                 uwriteln!(self.src, r#"NativeMemory.Free((void*){});"#, operands[0]);
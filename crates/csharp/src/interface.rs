@@ -262,6 +262,7 @@ impl InterfaceGenerator<'_> {
 
         if include_additional_functions {
             funcs.push(self.gen_import_src(func, &results, ParameterType::Span));
+            funcs.push(self.gen_import_src(func, &results, ParameterType::ReadOnlySpan));
             funcs.push(self.gen_import_src(func, &results, ParameterType::Memory));
         }
 
@@ -407,13 +408,15 @@ impl InterfaceGenerator<'_> {
             }
         };
 
+        let parameter_type = self.export_parameter_type(func);
+
         let mut bindgen = FunctionBindgen::new(
             self,
             &func.item_name(),
             &func.kind,
             (0..sig.params.len()).map(|i| format!("p{i}")).collect(),
             results,
-            ParameterType::ABI,
+            parameter_type,
         );
 
         abi::call(
@@ -460,7 +463,7 @@ impl InterfaceGenerator<'_> {
                 0
             })
             .map(|(name, ty)| {
-                let ty = self.type_name(ty);
+                let ty = self.name_with_qualifier(ty, false, parameter_type);
                 let name = name.to_csharp_ident();
                 format!("{ty} {name}")
             })
@@ -585,6 +588,73 @@ impl InterfaceGenerator<'_> {
         }
     }
 
+    /// Returns whether `ty` transitively contains a list of primitive
+    /// elements.
+    fn contains_primative_list(&mut self, ty: &Type) -> bool {
+        let resolve = self.resolve;
+        match ty {
+            Type::Id(id) => match &resolve.types[*id].kind {
+                TypeDefKind::Type(ty) => self.contains_primative_list(ty),
+                TypeDefKind::List(ty) => {
+                    crate::world_generator::is_primitive(ty) || self.contains_primative_list(ty)
+                }
+                TypeDefKind::Record(record) => record
+                    .fields
+                    .iter()
+                    .any(|field| self.contains_primative_list(&field.ty)),
+                TypeDefKind::Tuple(tuple) => tuple
+                    .types
+                    .iter()
+                    .any(|ty| self.contains_primative_list(ty)),
+                TypeDefKind::Variant(variant) => variant
+                    .cases
+                    .iter()
+                    .filter_map(|case| case.ty.as_ref())
+                    .any(|ty| self.contains_primative_list(ty)),
+                TypeDefKind::Option(ty) => self.contains_primative_list(ty),
+                TypeDefKind::Result(result) => result
+                    .ok
+                    .iter()
+                    .chain(result.err.iter())
+                    .any(|ty| self.contains_primative_list(ty)),
+                _ => false,
+            },
+            _ => false,
+        }
+    }
+
+    /// Parameter style used in `func`'s exported signature.
+    ///
+    /// With the `span-exports` option, primitive lists are received as
+    /// `Span<T>` over linear memory instead of managed array copies. Spans
+    /// are ref structs and cannot be stored in composite types, so the
+    /// option only applies when every primitive list lifted for the call is
+    /// itself a top-level parameter.
+    fn export_parameter_type(&mut self, func: &Function) -> ParameterType {
+        if !self.csharp_gen.opts.span_exports {
+            return ParameterType::ABI;
+        }
+        let mut any_primitive_list = false;
+        for (_, ty) in func.params.iter().skip(
+            if let FunctionKind::Method(_) = &func.kind {
+                1
+            } else {
+                0
+            },
+        ) {
+            if self.is_primative_list(ty) {
+                any_primitive_list = true;
+            } else if self.contains_primative_list(ty) {
+                return ParameterType::ABI;
+            }
+        }
+        if any_primitive_list {
+            ParameterType::Span
+        } else {
+            ParameterType::ABI
+        }
+    }
+
     pub(crate) fn name_with_qualifier(
         &mut self,
         ty: &Type,
@@ -613,10 +683,14 @@ impl InterfaceGenerator<'_> {
                     }
                     TypeDefKind::List(ty) => {
                         if crate::world_generator::is_primitive(ty)
-                            && self.direction == Direction::Import
                             && parameter_type == ParameterType::Span
                         {
                             format!("Span<{}>", self.type_name(ty))
+                        } else if crate::world_generator::is_primitive(ty)
+                            && self.direction == Direction::Import
+                            && parameter_type == ParameterType::ReadOnlySpan
+                        {
+                            format!("ReadOnlySpan<{}>", self.type_name(ty))
                         } else if crate::world_generator::is_primitive(ty)
                             && self.direction == Direction::Import
                             && parameter_type == ParameterType::Memory
@@ -920,6 +994,7 @@ impl InterfaceGenerator<'_> {
     }
 
     fn sig_string(&mut self, func: &Function, qualifier: bool) -> String {
+        let parameter_type = self.export_parameter_type(func);
         let result_type = if let FunctionKind::Constructor(_) = &func.kind {
             String::new()
         } else {
@@ -961,7 +1036,7 @@ impl InterfaceGenerator<'_> {
                 0
             })
             .map(|(name, ty)| {
-                let ty = self.type_name_with_qualifier(ty, qualifier);
+                let ty = self.name_with_qualifier(ty, qualifier, parameter_type);
                 let name = name.to_csharp_ident();
                 format!("{ty} {name}")
             })
@@ -1267,6 +1342,7 @@ impl<'a> CoreInterfaceGenerator<'a> for InterfaceGenerator<'a> {
 pub(crate) enum ParameterType {
     ABI,
     Span,
+    ReadOnlySpan,
     Memory,
 }
 
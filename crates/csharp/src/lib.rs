@@ -34,6 +34,12 @@ pub struct Opts {
     /// Generate code for WIT `Result` types instead of exceptions
     #[cfg_attr(feature = "clap", arg(long))]
     pub with_wit_results: bool,
+
+    /// Generate exported method signatures which accept `Span<T>` for lists
+    /// of primitive element types, wrapping linear memory directly instead
+    /// of copying each list into a managed array
+    #[cfg_attr(feature = "clap", arg(long))]
+    pub span_exports: bool,
 }
 
 impl Opts {
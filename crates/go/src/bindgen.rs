@@ -528,6 +528,25 @@ impl<'a, 'b> FunctionBindgen<'a, 'b> {
                     TypeDefKind::List(l) => {
                         self.interface.gen.with_import_unsafe(true);
                         let list_ty = self.interface.get_ty(&Type::Id(*id));
+                        // Lists of primitive scalars have the same in-memory
+                        // representation as the canonical buffer, so construct
+                        // the slice header directly over it instead of copying
+                        // every element. The buffer stays alive for the
+                        // lifetime of the slice, which matches the copying
+                        // path below since that never frees it either.
+                        if !matches!(l, Type::Id(_)) && self.interface.resolve.all_bits_valid(l) {
+                            let elem_ty = self.interface.get_ty(l);
+                            uwriteln!(self.lift_src, "var {lift_name} {list_ty}");
+                            uwriteln!(self.lift_src, "if {param}.len > 0 {{");
+                            uwriteln!(
+                                self.lift_src,
+                                "// use unsafe.Slice to avoid copy
+                                {lift_name} = unsafe.Slice((*{elem_ty})(unsafe.Pointer({param}.ptr)), int({param}.len))"
+                            );
+                            self.lift_src.push_str("}
+");
+                            return;
+                        }
                         let c_ty_name = self.interface.gen.get_c_ty(l);
                         uwriteln!(self.lift_src, "var {lift_name} {list_ty}",);
                         uwriteln!(self.lift_src, "{lift_name} = make({list_ty}, {param}.len)");
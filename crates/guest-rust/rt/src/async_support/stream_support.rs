@@ -10,6 +10,7 @@ use {
         stream::Stream,
     },
     std::{
+        any::Any,
         boxed::Box,
         collections::hash_map::Entry,
         convert::Infallible,
@@ -72,8 +73,17 @@ pub struct StreamWriter<T: 'static> {
     handle: u32,
     future: Option<Pin<Box<dyn Future<Output = ()> + 'static>>>,
     vtable: &'static StreamVtable<T>,
+    /// Elements coalesced locally until `batch_threshold` is reached.
+    batch: Vec<T>,
+    /// When non-zero, writes are buffered in `batch` until at least this
+    /// many elements are pending.
+    batch_threshold: usize,
 }
 
+// `StreamWriter` is used exclusively through `&mut self` and never relies on
+// address stability, so it is `Unpin` regardless of whether `T` is.
+impl<T> Unpin for StreamWriter<T> {}
+
 impl<T> StreamWriter<T> {
     #[doc(hidden)]
     pub fn new(handle: u32, vtable: &'static StreamVtable<T>) -> Self {
@@ -81,6 +91,8 @@ impl<T> StreamWriter<T> {
             handle,
             future: None,
             vtable,
+            batch: Vec::new(),
+            batch_threshold: 0,
         }
     }
 
@@ -92,6 +104,42 @@ impl<T> StreamWriter<T> {
         self.future = None;
     }
 
+    /// Configure write batching.
+    ///
+    /// When `threshold` is non-zero, elements passed to [`Sink::start_send`]
+    /// are buffered locally and written as a single operation once at least
+    /// `threshold` elements are pending, so a burst of small sends crosses
+    /// the canonical ABI once instead of once per send. Flushing or closing
+    /// the sink writes out any remainder; elements still batched when the
+    /// writer is dropped without a flush are discarded. A threshold of 0
+    /// (the default) disables batching.
+    pub fn set_batch_threshold(&mut self, threshold: usize) {
+        self.batch_threshold = threshold;
+    }
+
+    /// Queue the concatenated contents of `buffers` as a single write.
+    ///
+    /// Equivalent to sending each buffer individually, but the elements are
+    /// gathered first so the canonical ABI is crossed once for the whole
+    /// batch instead of once per buffer. As with [`Sink::start_send`], the
+    /// sink must be ready before calling this.
+    pub fn send_vectored(
+        &mut self,
+        buffers: impl IntoIterator<Item = Vec<T>>,
+    ) -> Result<(), Infallible> {
+        let mut buffers = buffers.into_iter();
+        let Some(mut joined) = buffers.next() else {
+            return Ok(());
+        };
+        for buffer in buffers {
+            joined.extend(buffer);
+        }
+        if joined.is_empty() {
+            return Ok(());
+        }
+        Pin::new(self).start_send(joined)
+    }
+
     /// Close the writer with an error that will be returned as the last value
     ///
     /// Note that this error is not sent immediately, but only when the
@@ -137,6 +185,47 @@ impl<T> Sink<Vec<T>> for StreamWriter<T> {
     }
 
     fn start_send(self: Pin<&mut Self>, item: Vec<T>) -> Result<(), Self::Error> {
+        let me = self.get_mut();
+        if me.batch_threshold > 0 {
+            me.batch.extend(item);
+            if me.batch.len() < me.batch_threshold {
+                return Ok(());
+            }
+            let batch = mem::take(&mut me.batch);
+            Pin::new(me).send_now(batch);
+        } else {
+            Pin::new(me).send_now(item);
+        }
+        Ok(())
+    }
+
+    fn poll_flush(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Result<(), Self::Error>> {
+        let me = self.get_mut();
+        loop {
+            match Pin::new(&mut *me).poll_ready(cx) {
+                Poll::Ready(Ok(())) => {
+                    // Write out any batched elements before reporting the
+                    // flush as complete.
+                    if me.batch.is_empty() {
+                        return Poll::Ready(Ok(()));
+                    }
+                    let batch = mem::take(&mut me.batch);
+                    Pin::new(&mut *me).send_now(batch);
+                }
+                other => return other,
+            }
+        }
+    }
+
+    fn poll_close(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Result<(), Self::Error>> {
+        self.poll_flush(cx)
+    }
+}
+
+impl<T> StreamWriter<T> {
+    /// Starts an actual write operation for `item`, bypassing the local
+    /// batch buffer.
+    fn send_now(self: Pin<&mut Self>, item: Vec<T>) {
         assert!(self.future.is_none());
         super::with_entry(self.handle, |entry| match entry {
             Entry::Vacant(_) => unreachable!(),
@@ -199,15 +288,6 @@ impl<T> Sink<Vec<T>> for StreamWriter<T> {
                 }
             },
         });
-        Ok(())
-    }
-
-    fn poll_flush(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Result<(), Self::Error>> {
-        self.poll_ready(cx)
-    }
-
-    fn poll_close(self: Pin<&mut Self>, cx: &mut Context) -> Poll<Result<(), Self::Error>> {
-        self.poll_ready(cx)
     }
 }
 
@@ -329,6 +409,102 @@ impl<T> StreamReader<T> {
         }
     }
 
+    /// Read directly into the spare capacity of `buffer`.
+    ///
+    /// Unlike the [`Stream`] implementation, which allocates a fresh buffer
+    /// for every read and yields it as a `Vec<T>`, this reads into storage
+    /// the caller provides — typically a buffer reused across reads, or one
+    /// slot of a caller-managed ring — so a receive loop performs no
+    /// per-read allocation. At most `buffer`'s spare capacity is read in the
+    /// one operation; if the buffer has no spare capacity a default one is
+    /// reserved first. Returns the number of elements appended, or `None`
+    /// once the stream is closed.
+    ///
+    /// This will panic if a read started through the [`Stream`]
+    /// implementation is still pending.
+    pub async fn read_into(&mut self, buffer: &mut Vec<T>) -> Option<Result<usize, ErrorContext>> {
+        enum Read<T> {
+            Host,
+            Local(oneshot::Receiver<Box<dyn Any>>),
+            Ready(Vec<T>),
+            Closed(Option<ErrorContext>),
+        }
+
+        assert!(self.future.is_none());
+        let handle = self.handle.load(Relaxed);
+        let read = super::with_entry(handle, |entry| match entry {
+            Entry::Vacant(_) => unreachable!(),
+            Entry::Occupied(mut entry) => match entry.get_mut() {
+                Handle::Write | Handle::LocalWaiting(_) => unreachable!(),
+                Handle::Read => Read::Host,
+                Handle::LocalOpen => {
+                    let (tx, rx) = oneshot::channel();
+                    entry.insert(Handle::LocalWaiting(tx));
+                    Read::Local(rx)
+                }
+                Handle::LocalClosed => Read::Closed(None),
+                Handle::WriteClosedErr(err_ctx) => Read::Closed(err_ctx.take()),
+                Handle::LocalReady(..) => {
+                    let Handle::LocalReady(v, waker) = entry.insert(Handle::LocalOpen) else {
+                        unreachable!()
+                    };
+                    waker.wake();
+                    Read::Ready(*v.downcast().unwrap())
+                }
+            },
+        });
+
+        match read {
+            Read::Host => {
+                let mut cancel_on_drop = CancelReadOnDrop::<T> {
+                    handle: Some(handle),
+                    vtable: self.vtable,
+                };
+                if buffer.spare_capacity_mut().is_empty() {
+                    buffer.reserve(ceiling(64 * 1024, mem::size_of::<T>().max(1)));
+                }
+                let result = match (self.vtable.read)(handle, buffer.spare_capacity_mut()).await {
+                    Some(Ok(count)) => {
+                        // SAFETY: the host just initialized `count` elements
+                        // of the spare capacity.
+                        unsafe { buffer.set_len(buffer.len() + count) }
+                        Some(Ok(count))
+                    }
+                    Some(Err(err)) => Some(Err(err)),
+                    None => None,
+                };
+                cancel_on_drop.handle = None;
+                drop(cancel_on_drop);
+                result
+            }
+            Read::Local(rx) => {
+                let mut cancel_on_drop = CancelReadOnDrop::<T> {
+                    handle: Some(handle),
+                    vtable: self.vtable,
+                };
+                let result = rx
+                    .map(|v| {
+                        v.ok().map(|v| {
+                            let values = *v.downcast::<Vec<T>>().unwrap();
+                            let count = values.len();
+                            buffer.extend(values);
+                            Ok(count)
+                        })
+                    })
+                    .await;
+                cancel_on_drop.handle = None;
+                drop(cancel_on_drop);
+                result
+            }
+            Read::Ready(values) => {
+                let count = values.len();
+                buffer.extend(values);
+                Some(Ok(count))
+            }
+            Read::Closed(err_ctx) => err_ctx.map(Err),
+        }
+    }
+
     #[doc(hidden)]
     pub fn take_handle(&self) -> u32 {
         let handle = self.handle.swap(u32::MAX, Relaxed);
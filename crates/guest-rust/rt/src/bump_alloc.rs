@@ -0,0 +1,165 @@
+//! A resettable bump allocator for short-lived, request-scoped components.
+//!
+//! Canonical allocations cannot be redirected to a bump region on their
+//! own: buffers produced by `cabi_realloc` are lifted straight into owned
+//! `Vec`s and `String`s whose destructors return the memory through the
+//! global allocator, so a `cabi_realloc`-only fast path would hand out
+//! pointers that later get deallocated by an allocator that never issued
+//! them. The sound shape is for the bump region to *be* the global
+//! allocator; `cabi_realloc` forwards to it automatically and every
+//! deallocation becomes a no-op.
+//!
+//! ```ignore
+//! #[global_allocator]
+//! static ALLOC: wit_bindgen_rt::bump_alloc::BumpAllocator =
+//!     wit_bindgen_rt::bump_alloc::BumpAllocator::new();
+//! ```
+//!
+//! Memory is claimed from the wasm linear memory with `memory.grow` and
+//! never returned, so for an instantiate-per-request deployment nothing
+//! else is needed: the instance is torn down with the request. A reused
+//! instance can instead call [`BumpAllocator::reset`] at its quiescent
+//! point (after a response has been post-returned and before the next
+//! request) to rewind the region wholesale.
+
+use core::alloc::{GlobalAlloc, Layout};
+use core::cell::UnsafeCell;
+
+#[cfg(target_arch = "wasm32")]
+const PAGE_SIZE: usize = 64 * 1024;
+
+/// A `#[global_allocator]` which bump-allocates out of linear memory
+/// claimed with `memory.grow` and only ever frees by rewinding.
+pub struct BumpAllocator {
+    state: UnsafeCell<State>,
+}
+
+struct State {
+    /// Start of the region that `reset` rewinds to.
+    base: usize,
+    /// Next free byte.
+    cursor: usize,
+    /// End of the grown region.
+    end: usize,
+}
+
+// Wasm guests are single-threaded; this mirrors the `static mut` use in
+// `run_ctors_once`.
+unsafe impl Sync for BumpAllocator {}
+
+impl BumpAllocator {
+    pub const fn new() -> BumpAllocator {
+        BumpAllocator {
+            state: UnsafeCell::new(State {
+                base: 0,
+                cursor: 0,
+                end: 0,
+            }),
+        }
+    }
+
+    /// Rewinds the region, reclaiming every allocation made since the
+    /// last reset in one step.
+    ///
+    /// # Safety
+    ///
+    /// All memory handed out since the previous reset is reused
+    /// afterwards, so no allocation made through this allocator may still
+    /// be live: call this only at a quiescent point such as between
+    /// requests, after any post-return has run and when no `Vec`,
+    /// `String`, `Box`, or other owned value remains.
+    pub unsafe fn reset(&self) {
+        let state = &mut *self.state.get();
+        state.cursor = state.base;
+    }
+}
+
+impl State {
+    #[cfg(target_arch = "wasm32")]
+    unsafe fn grow(&mut self, needed: usize) -> bool {
+        let pages = needed.div_ceil(PAGE_SIZE);
+        let prev = core::arch::wasm32::memory_grow::<0>(pages);
+        if prev == usize::MAX {
+            return false;
+        }
+        let start = prev * PAGE_SIZE;
+        if start != self.end || self.end == 0 {
+            // Either the very first block or something else grew memory in
+            // between; start the region over at the new block so a later
+            // `reset` can never rewind into foreign pages.
+            self.base = start;
+            self.cursor = start;
+        }
+        self.end = start + pages * PAGE_SIZE;
+        true
+    }
+
+    #[cfg(not(target_arch = "wasm32"))]
+    unsafe fn grow(&mut self, _needed: usize) -> bool {
+        false
+    }
+}
+
+impl Default for BumpAllocator {
+    fn default() -> BumpAllocator {
+        BumpAllocator::new()
+    }
+}
+
+unsafe impl GlobalAlloc for BumpAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let state = &mut *self.state.get();
+        loop {
+            let aligned = state.cursor.wrapping_add(layout.align() - 1) & !(layout.align() - 1);
+            if state.end != 0 && aligned + layout.size() <= state.end {
+                state.cursor = aligned + layout.size();
+                return aligned as *mut u8;
+            }
+            // Growth may restart the region at a fresh block, so re-derive
+            // the slot on the next iteration rather than assuming the new
+            // pages extend the old ones.
+            if !state.grow(aligned + layout.size() - state.end) {
+                return core::ptr::null_mut();
+            }
+        }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        // Memory is only reclaimed by `reset`, but rewind the trivial case
+        // of freeing the most recent allocation so grow-in-place loops
+        // (such as `cabi_realloc` resizing a staging buffer) don't leak
+        // every intermediate size.
+        let state = &mut *self.state.get();
+        if ptr as usize + layout.size() == state.cursor {
+            state.cursor = ptr as usize;
+        }
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        // Extend the most recent allocation in place when possible; this
+        // is the common shape of `cabi_realloc` growing a buffer the host
+        // is filling in.
+        let state = &mut *self.state.get();
+        if ptr as usize + layout.size() == state.cursor {
+            let end = ptr as usize + new_size;
+            if end <= state.end {
+                state.cursor = end;
+                return ptr;
+            }
+        }
+        let new_ptr = self.alloc(Layout::from_size_align_unchecked(new_size, layout.align()));
+        if !new_ptr.is_null() {
+            core::ptr::copy_nonoverlapping(
+                ptr,
+                new_ptr,
+                if layout.size() < new_size {
+                    layout.size()
+                } else {
+                    new_size
+                },
+            );
+            self.dealloc(ptr, layout);
+        }
+        new_ptr
+    }
+}
@@ -116,3 +116,8 @@ pub fn run_ctors_once() {
 /// Support for using the Component Model Async ABI
 #[cfg(feature = "async")]
 pub mod async_support;
+
+/// A resettable bump allocator for request-scoped components; see the
+/// module documentation for how it relates to `cabi_realloc`.
+#[cfg(feature = "bump-alloc")]
+pub mod bump_alloc;
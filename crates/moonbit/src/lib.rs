@@ -2345,7 +2345,7 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 uwrite!(
                     self.src,
                     "
-                    let {array} : Array[{ty}] = [];
+                    let {array} : Array[{ty}] = Array::new(capacity = {length});
                     for {index} = 0; {index} < ({length}); {index} = {index} + 1 {{
                         let {base} = ({address}) + ({index} * {size})
                         {body}
@@ -2694,6 +2694,10 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 results.extend(operands.iter().take(*amt).map(|v| v.clone()));
             }
 
+            // Only generated for backends that opt in via
+            // `Bindgen::is_wide_copy`.
+            Instruction::WideStore { .. } | Instruction::WideLoad { .. } => unreachable!(),
+
             Instruction::AsyncMalloc { .. }
             | Instruction::AsyncPostCallInterface { .. }
             | Instruction::AsyncCallReturn { .. }
@@ -731,6 +731,11 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                 results.push(len);
             }
 
+            // Note that lifting here takes ownership of the canonical buffer
+            // rather than copying out of it: the caller allocated it with
+            // `cabi_realloc`, which forwards to the Rust global allocator, so
+            // it's handed off to `Vec` (and later freed by `Vec`'s
+            // destructor) without any new allocation.
             Instruction::ListCanonLift { .. } => {
                 let tmp = self.tmp();
                 let len = format!("len{}", tmp);
@@ -1187,6 +1192,10 @@ impl Bindgen for FunctionBindgen<'_, '_> {
 
             Instruction::Malloc { .. } => unimplemented!(),
 
+            // Only generated for backends that opt in via
+            // `Bindgen::is_wide_copy`.
+            Instruction::WideStore { .. } | Instruction::WideLoad { .. } => unreachable!(),
+
             Instruction::GuestDeallocate { size, align } => {
                 let dealloc = self.gen.path_to_cabi_dealloc();
                 self.push_str(&format!(
@@ -215,6 +215,12 @@ pub struct Opts {
     ///
     /// - `borrowing-duplicate-if-necessary`: As above, but generating distinct
     /// types for borrowing and owning, if necessary.
+    ///
+    /// Note that this only affects the parameters of imported functions:
+    /// exported functions always receive owned values. Owned lists and
+    /// strings are lifted by taking ownership of the canonical buffer the
+    /// caller allocated through `cabi_realloc`, so this does not introduce a
+    /// per-call allocation or copy.
     #[cfg_attr(feature = "clap", arg(long, default_value_t = Ownership::Owning))]
     pub ownership: Ownership,
 
@@ -1615,7 +1615,7 @@ impl Bindgen for FunctionBindgen<'_, '_> {
             }
 
             Instruction::ListCanonLift { element, .. } => {
-                let (_, ty) = list_element_info(element);
+                let (size, ty) = list_element_info(element);
                 let ty_upper = ty.to_upper_camel_case();
                 let array = self.locals.tmp("array");
                 let address = &operands[0];
@@ -1626,6 +1626,7 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     "
                     {ty}[] {array} = new {ty}[{length}];
                     Memory.get{ty_upper}s(org.teavm.interop.Address.fromInt({address}), {array}, 0, ({array}).length);
+                    Memory.free(org.teavm.interop.Address.fromInt({address}), ({length}) * {size}, {size});
                     "
                 );
 
@@ -1668,6 +1669,7 @@ impl Bindgen for FunctionBindgen<'_, '_> {
                     "
                     byte[] {bytes} = new byte[{length}];
                     Memory.getBytes(org.teavm.interop.Address.fromInt({address}), {bytes}, 0, {length});
+                    Memory.free(org.teavm.interop.Address.fromInt({address}), {length}, 1);
                     "
                 );
 
@@ -1966,6 +1968,10 @@ impl Bindgen for FunctionBindgen<'_, '_> {
 
             Instruction::Malloc { .. } => unimplemented!(),
 
+            // Only generated for backends that opt in via
+            // `Bindgen::is_wide_copy`.
+            Instruction::WideStore { .. } | Instruction::WideLoad { .. } => unreachable!(),
+
             Instruction::GuestDeallocate { size, align } => {
                 uwriteln!(
                     self.src,
@@ -0,0 +1,91 @@
+//! Host-side plumbing for the runtime benchmark suite.
+//!
+//! The runtime tests already build one component per generator for each
+//! world; this module holds the generator-agnostic half of benchmarking
+//! them: timing a call loop from the host and persisting the measurements
+//! as JSON, so results from different backends (and different commits) can
+//! be compared mechanically.
+
+use std::fs;
+use std::path::PathBuf;
+use std::time::Instant;
+
+/// One timed ABI shape for one backend.
+pub struct Measurement {
+    pub shape: String,
+    pub iterations: u32,
+    pub ns_per_call: f64,
+    /// Zero for shapes that move no payload.
+    pub bytes_per_sec: f64,
+}
+
+/// Times `iterations` invocations of `f` and attributes `payload_bytes` of
+/// payload to each call when computing throughput.
+///
+/// One warmup invocation runs before the clock starts so lazily-compiled
+/// paths and first-touch allocations don't land in the measurement.
+pub fn measure(
+    shape: &str,
+    iterations: u32,
+    payload_bytes: u64,
+    mut f: impl FnMut(),
+) -> Measurement {
+    f();
+    let start = Instant::now();
+    for _ in 0..iterations {
+        f();
+    }
+    let elapsed = start.elapsed().as_nanos() as f64;
+    let bytes_per_sec = if payload_bytes > 0 && elapsed > 0.0 {
+        (payload_bytes * u64::from(iterations)) as f64 * 1e9 / elapsed
+    } else {
+        0.0
+    };
+    Measurement {
+        shape: shape.to_string(),
+        iterations,
+        ns_per_call: elapsed / f64::from(iterations.max(1)),
+        bytes_per_sec,
+    }
+}
+
+/// Returns the directory benchmark results are written to, a sibling of
+/// the suite directories created by [`super::test_directory`].
+pub fn results_directory() -> PathBuf {
+    let mut me = std::env::current_exe().unwrap();
+    me.pop(); // chop off exe name
+    me.pop(); // chop off 'deps'
+    me.pop(); // chop off 'debug' / 'release'
+    me.push("benchmark-results");
+    fs::create_dir_all(&me).unwrap();
+    me
+}
+
+/// Writes one backend's measurements for `world` to
+/// `benchmark-results/{world}-{backend}.json` and returns the path.
+///
+/// The JSON is assembled by hand since the workspace has no serialization
+/// dependency; world, backend, and shape names are plain identifiers so no
+/// escaping is needed.
+pub fn write_json(world: &str, backend: &str, measurements: &[Measurement]) -> PathBuf {
+    let mut json = String::new();
+    json.push_str("{\n");
+    json.push_str(&format!("  \"world\": \"{world}\",\n"));
+    json.push_str(&format!("  \"backend\": \"{backend}\",\n"));
+    json.push_str("  \"measurements\": [\n");
+    for (i, m) in measurements.iter().enumerate() {
+        json.push_str(&format!(
+            "    {{\"shape\": \"{}\", \"iterations\": {}, \"ns_per_call\": {:.1}, \"bytes_per_sec\": {:.1}}}{}\n",
+            m.shape,
+            m.iterations,
+            m.ns_per_call,
+            m.bytes_per_sec,
+            if i + 1 == measurements.len() { "" } else { "," },
+        ));
+    }
+    json.push_str("  ]\n}\n");
+
+    let dst = results_directory().join(format!("{world}-{backend}.json"));
+    fs::write(&dst, json).unwrap();
+    dst
+}
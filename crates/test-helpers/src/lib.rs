@@ -1,5 +1,7 @@
 pub use codegen_macro::*;
 
+pub mod benchmark;
+
 use std::fs;
 use std::path::{Path, PathBuf};
 use std::process::Command;
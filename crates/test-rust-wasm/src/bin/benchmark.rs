@@ -0,0 +1,3 @@
+include!("../../../../tests/runtime/benchmark/wasm.rs");
+
+fn main() {}
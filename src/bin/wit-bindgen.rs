@@ -1,6 +1,8 @@
 use anyhow::{bail, Context, Error, Result};
 use clap::Parser;
-use std::path::PathBuf;
+use std::collections::hash_map::DefaultHasher;
+use std::hash::Hasher;
+use std::path::{Path, PathBuf};
 use std::str;
 use wit_bindgen_core::{wit_parser, Files, WorldGenerator};
 use wit_parser::Resolve;
@@ -118,10 +120,20 @@ struct Common {
     /// This enables using `@unstable` annotations in WIT files.
     #[clap(long)]
     all_features: bool,
+
+    /// Optional directory used to cache generated output between invocations.
+    ///
+    /// When the WIT inputs and the full command line match a previous
+    /// invocation the cached files are emitted byte-for-byte without parsing
+    /// or regenerating anything. The cache key covers every file beneath the
+    /// `WIT` path, so any change to any input regenerates the whole world
+    /// (interfaces are not independently cacheable; see the notes on
+    /// `WorldGenerator::generate`).
+    #[clap(long)]
+    cache_dir: Option<PathBuf>,
 }
 
 fn main() -> Result<()> {
-    let mut files = Files::default();
     let (generator, opt) = match Opt::parse() {
         #[cfg(feature = "markdown")]
         Opt::Markdown { opts, args } => (opts.build(), args),
@@ -139,9 +151,29 @@ fn main() -> Result<()> {
         Opt::CSharp { opts, args } => (opts.build(), args),
     };
 
-    gen_world(generator, &opt, &mut files).map_err(attach_with_context)?;
+    let cache = opt
+        .cache_dir
+        .as_ref()
+        .map(|dir| cache_entry(dir, &opt.wit))
+        .transpose()?;
+
+    let outputs = match &cache {
+        Some(entry) if entry.is_hit() => entry.load()?,
+        _ => {
+            let mut files = Files::default();
+            gen_world(generator, &opt, &mut files).map_err(attach_with_context)?;
+            let outputs = files
+                .iter()
+                .map(|(name, contents)| (name.to_string(), contents.to_vec()))
+                .collect::<Vec<_>>();
+            if let Some(entry) = &cache {
+                entry.store(&outputs)?;
+            }
+            outputs
+        }
+    };
 
-    for (name, contents) in files.iter() {
+    for (name, contents) in outputs.iter() {
         let dst = match &opt.out_dir {
             Some(path) => path.join(name),
             None => name.into(),
@@ -150,7 +182,7 @@ fn main() -> Result<()> {
 
         if opt.check {
             let prev = std::fs::read(&dst).with_context(|| format!("failed to read {:?}", dst))?;
-            if prev != contents {
+            if prev != *contents {
                 // The contents differ. If it looks like textual contents, do a
                 // line-by-line comparison so that we can tell users what the
                 // problem is directly.
@@ -182,6 +214,99 @@ fn main() -> Result<()> {
     Ok(())
 }
 
+struct CacheEntry {
+    /// Directory holding this invocation's cached output, named after the
+    /// hash of `key`.
+    dir: PathBuf,
+    /// Full key material: the command line plus the contents of every input
+    /// file. Stored verbatim and compared exactly on lookup so a hash
+    /// collision can never restore the wrong output.
+    key: Vec<u8>,
+}
+
+fn cache_entry(cache_dir: &Path, wit: &Path) -> Result<CacheEntry> {
+    let mut key = Vec::new();
+    key.extend_from_slice(version().as_bytes());
+    for arg in std::env::args() {
+        key.push(0);
+        key.extend_from_slice(arg.as_bytes());
+    }
+
+    // Hash every file beneath the `WIT` path rather than asking the parser
+    // which files it would read; this keeps cache hits from having to parse
+    // at all, at the cost of also keying on unrelated files in the directory.
+    let mut inputs = Vec::new();
+    collect_inputs(wit, &mut inputs)?;
+    inputs.sort();
+    for path in inputs {
+        let contents =
+            std::fs::read(&path).with_context(|| format!("failed to read {:?}", path))?;
+        key.push(0);
+        key.extend_from_slice(path.to_string_lossy().as_bytes());
+        key.push(0);
+        key.extend_from_slice(&contents);
+    }
+
+    let mut hasher = DefaultHasher::new();
+    hasher.write(&key);
+    let dir = cache_dir.join(format!("{:016x}", hasher.finish()));
+    Ok(CacheEntry { dir, key })
+}
+
+fn collect_inputs(path: &Path, inputs: &mut Vec<PathBuf>) -> Result<()> {
+    if path.is_dir() {
+        for entry in
+            std::fs::read_dir(path).with_context(|| format!("failed to read {:?}", path))?
+        {
+            collect_inputs(&entry?.path(), inputs)?;
+        }
+    } else {
+        inputs.push(path.to_path_buf());
+    }
+    Ok(())
+}
+
+impl CacheEntry {
+    fn is_hit(&self) -> bool {
+        match std::fs::read(self.dir.join("key")) {
+            Ok(prev) => prev == self.key,
+            Err(_) => false,
+        }
+    }
+
+    fn load(&self) -> Result<Vec<(String, Vec<u8>)>> {
+        let mut outputs = Vec::new();
+        let root = self.dir.join("files");
+        for name in std::fs::read_to_string(self.dir.join("list"))?.lines() {
+            let contents = std::fs::read(root.join(name))
+                .with_context(|| format!("failed to read cached {name:?}"))?;
+            outputs.push((name.to_string(), contents));
+        }
+        Ok(outputs)
+    }
+
+    fn store(&self, outputs: &[(String, Vec<u8>)]) -> Result<()> {
+        let root = self.dir.join("files");
+        let mut list = String::new();
+        for (name, contents) in outputs {
+            let dst = root.join(name);
+            if let Some(parent) = dst.parent() {
+                std::fs::create_dir_all(parent)
+                    .with_context(|| format!("failed to create {:?}", parent))?;
+            }
+            std::fs::write(&dst, contents).with_context(|| format!("failed to write {:?}", dst))?;
+            list.push_str(name);
+            list.push('\n');
+        }
+        std::fs::create_dir_all(&self.dir)
+            .with_context(|| format!("failed to create {:?}", self.dir))?;
+        std::fs::write(self.dir.join("list"), list)?;
+        // Written last: a partially populated entry is never a hit.
+        std::fs::write(self.dir.join("key"), &self.key)?;
+        Ok(())
+    }
+}
+
 fn attach_with_context(err: Error) -> Error {
     #[cfg(feature = "rust")]
     if let Some(e) = err.downcast_ref::<wit_bindgen_rust::MissingWith>() {
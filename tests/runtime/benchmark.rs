@@ -0,0 +1,206 @@
+use anyhow::Result;
+use std::time::Instant;
+use wasmtime::Store;
+
+wasmtime::component::bindgen!({
+    path: "tests/runtime/benchmark",
+});
+
+pub struct MyImports {
+    start: Instant,
+}
+
+impl Default for MyImports {
+    fn default() -> MyImports {
+        MyImports {
+            start: Instant::now(),
+        }
+    }
+}
+
+impl bench::Host for MyImports {
+    fn now(&mut self) -> u64 {
+        self.start.elapsed().as_nanos() as u64
+    }
+
+    fn report(&mut self, name: String, ns_per_call: f64, bytes_per_sec: f64) {
+        if bytes_per_sec > 0.0 {
+            println!(
+                "benchmark {name}: {ns_per_call:.1} ns/call, {:.1} MB/s",
+                bytes_per_sec / 1e6
+            );
+        } else {
+            println!("benchmark {name}: {ns_per_call:.1} ns/call");
+        }
+    }
+
+    #[allow(clippy::too_many_arguments)]
+    fn scalar_args(
+        &mut self,
+        a1: u64,
+        a2: u64,
+        a3: u64,
+        a4: u64,
+        a5: u64,
+        a6: u64,
+        a7: u64,
+        a8: u64,
+        a9: u64,
+        a10: u64,
+        a11: u64,
+        a12: u64,
+        a13: u64,
+        a14: u64,
+        a15: u64,
+        a16: u64,
+    ) -> u64 {
+        a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11 + a12 + a13 + a14 + a15 + a16
+    }
+
+    fn list_u8_param(&mut self, a: Vec<u8>) -> u32 {
+        a.len() as u32
+    }
+
+    fn list_u8_result(&mut self, len: u32) -> Vec<u8> {
+        vec![0xab; len as usize]
+    }
+
+    fn string_param(&mut self, a: String) -> u32 {
+        a.len() as u32
+    }
+
+    fn string_result(&mut self, len: u32) -> String {
+        "x".repeat(len as usize)
+    }
+
+    fn option_param(&mut self, a: Option<u64>) -> u32 {
+        a.is_some() as u32
+    }
+}
+
+#[test]
+fn run() -> Result<()> {
+    crate::run_test(
+        "benchmark",
+        |linker| Benchmark::add_to_linker(linker, |x| &mut x.0),
+        |store, component, linker| Benchmark::instantiate(store, component, linker),
+        run_test,
+    )
+}
+
+fn run_test(benchmark: Benchmark, store: &mut Store<crate::Wasi<MyImports>>) -> Result<()> {
+    benchmark.call_run(&mut *store, iterations())?;
+    Ok(())
+}
+
+fn iterations() -> u32 {
+    // A small default keeps this suite fast in CI; raise the count when
+    // actually comparing generator changes.
+    std::env::var("WIT_BINDGEN_BENCH_ITERATIONS")
+        .ok()
+        .and_then(|s| s.parse().ok())
+        .unwrap_or(1_000)
+}
+
+/// The inverse of `run`: the host times calls into each exported shape, so
+/// the cost of a boundary crossing can be attributed to a backend's
+/// lowering rather than folded into guest-side loops. One JSON file per
+/// backend is written next to the other test output for mechanical
+/// comparison across backends and commits.
+#[test]
+fn host_side() -> Result<()> {
+    use wasmtime::component::{Component, Linker, ResourceTable};
+    use wasmtime::{Config, Engine};
+    use wasmtime_wasi::WasiCtxBuilder;
+
+    let mut config = Config::new();
+    config.cache_config_load_default()?;
+    config.wasm_component_model(true);
+    let engine = Engine::new(&config)?;
+
+    let iterations = iterations();
+    let mut seen = std::collections::HashSet::new();
+    for wasm in crate::tests("benchmark", "benchmark")? {
+        let backend = backend_name(&wasm);
+        // The C tests build the same source with both clang and clang++ to
+        // the same output path; time each artifact once.
+        if !seen.insert(backend.clone()) {
+            continue;
+        }
+
+        let component = Component::from_file(&engine, &wasm)?;
+        let mut linker = Linker::new(&engine);
+        Benchmark::add_to_linker(&mut linker, |x| &mut x.0)?;
+        wasmtime_wasi::add_to_linker_sync(&mut linker)?;
+
+        let wasi = WasiCtxBuilder::new().inherit_stdout().args(&[""]).build();
+        let data = crate::Wasi(
+            MyImports::default(),
+            crate::MyCtx {},
+            ResourceTable::new(),
+            wasi,
+        );
+        let mut store = Store::new(&engine, data);
+
+        let benchmark = Benchmark::instantiate(&mut store, &component, &linker)?;
+        let shapes = benchmark.shapes();
+
+        let list = vec![0xab_u8; 64 * 1024];
+        let string = "x".repeat(1024);
+        let payload = list.len() as u64;
+
+        use test_helpers::benchmark::measure;
+        let results = vec![
+            measure("scalar-args", iterations, 0, || {
+                shapes
+                    .call_scalar_args(
+                        &mut store, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16,
+                    )
+                    .unwrap();
+            }),
+            measure("list-u8-param", iterations, payload, || {
+                shapes.call_list_u8_param(&mut store, &list).unwrap();
+            }),
+            measure("list-u8-result", iterations, payload, || {
+                shapes
+                    .call_list_u8_result(&mut store, payload as u32)
+                    .unwrap();
+            }),
+            measure("string-param", iterations, string.len() as u64, || {
+                shapes.call_string_param(&mut store, &string).unwrap();
+            }),
+            measure("string-result", iterations, string.len() as u64, || {
+                shapes
+                    .call_string_result(&mut store, string.len() as u32)
+                    .unwrap();
+            }),
+            measure("option-param", iterations, 0, || {
+                shapes.call_option_param(&mut store, Some(42)).unwrap();
+            }),
+        ];
+
+        for m in &results {
+            if m.bytes_per_sec > 0.0 {
+                println!(
+                    "host->{backend} {}: {:.1} ns/call, {:.1} MB/s",
+                    m.shape,
+                    m.ns_per_call,
+                    m.bytes_per_sec / 1e6
+                );
+            } else {
+                println!("host->{backend} {}: {:.1} ns/call", m.shape, m.ns_per_call);
+            }
+        }
+        let json = test_helpers::benchmark::write_json("benchmark", &backend, &results);
+        println!("results written to {json:?}");
+    }
+
+    Ok(())
+}
+
+/// Maps a built component's path back to the generator that produced it,
+/// e.g. `rust.wasm` to "rust" and `c-wasm.component.wasm` to "c-wasm".
+fn backend_name(wasm: &std::path::Path) -> String {
+    let stem = wasm.file_stem().and_then(|s| s.to_str()).unwrap();
+    stem.strip_suffix(".component").unwrap_or(stem).to_string()
+}
@@ -0,0 +1,136 @@
+#include <benchmark.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keeps results observable so neither side of a call can be elided.
+static uint64_t sink;
+
+static void report(const char *name, uint64_t elapsed, uint32_t iterations,
+                   uint64_t bytes) {
+  benchmark_string_t s;
+  benchmark_string_set(&s, name);
+  double ns_per_call = (double) elapsed / (double) iterations;
+  double bytes_per_sec =
+      elapsed > 0 ? (double) bytes * 1e9 / (double) elapsed : 0.0;
+  bench_report(&s, ns_per_call, bytes_per_sec);
+}
+
+void exports_benchmark_run(uint32_t iterations) {
+  if (iterations == 0) {
+    iterations = 1;
+  }
+
+  {
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      sink += bench_scalar_args(i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i);
+    }
+    report("scalar-args", bench_now() - start, iterations, 0);
+  }
+
+  {
+    size_t len = 64 * 1024;
+    benchmark_list_u8_t a;
+    a.ptr = (uint8_t *) malloc(len);
+    a.len = len;
+    memset(a.ptr, 0xab, len);
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      sink += bench_list_u8_param(&a);
+    }
+    report("list-u8-param", bench_now() - start, iterations,
+           (uint64_t) len * iterations);
+    free(a.ptr);
+  }
+
+  {
+    uint32_t len = 64 * 1024;
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      benchmark_list_u8_t ret;
+      bench_list_u8_result(len, &ret);
+      sink += ret.len;
+      benchmark_list_u8_free(&ret);
+    }
+    report("list-u8-result", bench_now() - start, iterations,
+           (uint64_t) len * iterations);
+  }
+
+  {
+    size_t len = 1024;
+    benchmark_string_t a;
+    a.ptr = (uint8_t *) malloc(len);
+    a.len = len;
+    memset(a.ptr, 'x', len);
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      sink += bench_string_param(&a);
+    }
+    report("string-param", bench_now() - start, iterations,
+           (uint64_t) len * iterations);
+    free(a.ptr);
+  }
+
+  {
+    uint32_t len = 1024;
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      benchmark_string_t ret;
+      bench_string_result(len, &ret);
+      sink += ret.len;
+      benchmark_string_free(&ret);
+    }
+    report("string-result", bench_now() - start, iterations,
+           (uint64_t) len * iterations);
+  }
+
+  {
+    uint64_t some = 42;
+    uint64_t start = bench_now();
+    for (uint32_t i = 0; i < iterations; i++) {
+      sink += bench_option_param(i % 2 == 0 ? &some : NULL);
+    }
+    report("option-param", bench_now() - start, iterations, 0);
+  }
+}
+
+// The exported mirror of the shapes above, called in a loop by the
+// host-side harness. Each echoes its input the same way the host
+// implementations of the imports do.
+
+uint64_t shapes_scalar_args(uint64_t a1, uint64_t a2, uint64_t a3, uint64_t a4,
+                            uint64_t a5, uint64_t a6, uint64_t a7, uint64_t a8,
+                            uint64_t a9, uint64_t a10, uint64_t a11,
+                            uint64_t a12, uint64_t a13, uint64_t a14,
+                            uint64_t a15, uint64_t a16) {
+  return a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11 + a12 + a13 +
+         a14 + a15 + a16;
+}
+
+uint32_t shapes_list_u8_param(benchmark_list_u8_t *a) {
+  uint32_t len = (uint32_t) a->len;
+  benchmark_list_u8_free(a);
+  return len;
+}
+
+void shapes_list_u8_result(uint32_t len, benchmark_list_u8_t *ret) {
+  ret->ptr = (uint8_t *) malloc(len);
+  ret->len = len;
+  memset(ret->ptr, 0xab, len);
+}
+
+uint32_t shapes_string_param(benchmark_string_t *a) {
+  uint32_t len = (uint32_t) a->len;
+  benchmark_string_free(a);
+  return len;
+}
+
+void shapes_string_result(uint32_t len, benchmark_string_t *ret) {
+  ret->ptr = (uint8_t *) malloc(len);
+  ret->len = len;
+  memset(ret->ptr, 'x', len);
+}
+
+uint32_t shapes_option_param(uint64_t *maybe_a) {
+  return maybe_a != NULL;
+}
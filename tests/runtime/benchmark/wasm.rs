@@ -0,0 +1,151 @@
+wit_bindgen::generate!({
+    path: "../../tests/runtime/benchmark",
+});
+
+use std::sync::atomic::{AtomicU64, Ordering::SeqCst};
+
+// Keeps results observable so neither side of a call can be elided.
+static SINK: AtomicU64 = AtomicU64::new(0);
+
+struct Component;
+
+export!(Component);
+
+fn report(name: &str, elapsed: u64, iterations: u32, bytes: u64) {
+    let ns_per_call = elapsed as f64 / iterations as f64;
+    let bytes_per_sec = if elapsed > 0 {
+        bytes as f64 * 1e9 / elapsed as f64
+    } else {
+        0.0
+    };
+    bench::report(name, ns_per_call, bytes_per_sec);
+}
+
+impl Guest for Component {
+    fn run(iterations: u32) {
+        let iterations = iterations.max(1);
+
+        {
+            let start = bench::now();
+            for i in 0..iterations {
+                let i = u64::from(i);
+                SINK.fetch_add(
+                    bench::scalar_args(i, i, i, i, i, i, i, i, i, i, i, i, i, i, i, i),
+                    SeqCst,
+                );
+            }
+            report("scalar-args", bench::now() - start, iterations, 0);
+        }
+
+        {
+            let a = vec![0xab_u8; 64 * 1024];
+            let start = bench::now();
+            for _ in 0..iterations {
+                SINK.fetch_add(bench::list_u8_param(&a).into(), SeqCst);
+            }
+            report(
+                "list-u8-param",
+                bench::now() - start,
+                iterations,
+                a.len() as u64 * u64::from(iterations),
+            );
+        }
+
+        {
+            let len = 64 * 1024;
+            let start = bench::now();
+            for _ in 0..iterations {
+                let ret = bench::list_u8_result(len);
+                SINK.fetch_add(ret.len() as u64, SeqCst);
+            }
+            report(
+                "list-u8-result",
+                bench::now() - start,
+                iterations,
+                u64::from(len) * u64::from(iterations),
+            );
+        }
+
+        {
+            let a = "x".repeat(1024);
+            let start = bench::now();
+            for _ in 0..iterations {
+                SINK.fetch_add(bench::string_param(&a).into(), SeqCst);
+            }
+            report(
+                "string-param",
+                bench::now() - start,
+                iterations,
+                a.len() as u64 * u64::from(iterations),
+            );
+        }
+
+        {
+            let len = 1024;
+            let start = bench::now();
+            for _ in 0..iterations {
+                let ret = bench::string_result(len);
+                SINK.fetch_add(ret.len() as u64, SeqCst);
+            }
+            report(
+                "string-result",
+                bench::now() - start,
+                iterations,
+                u64::from(len) * u64::from(iterations),
+            );
+        }
+
+        {
+            let start = bench::now();
+            for i in 0..iterations {
+                let a = if i % 2 == 0 { Some(42) } else { None };
+                SINK.fetch_add(bench::option_param(a).into(), SeqCst);
+            }
+            report("option-param", bench::now() - start, iterations, 0);
+        }
+    }
+}
+
+impl exports::shapes::Guest for Component {
+    #[allow(clippy::too_many_arguments)]
+    fn scalar_args(
+        a1: u64,
+        a2: u64,
+        a3: u64,
+        a4: u64,
+        a5: u64,
+        a6: u64,
+        a7: u64,
+        a8: u64,
+        a9: u64,
+        a10: u64,
+        a11: u64,
+        a12: u64,
+        a13: u64,
+        a14: u64,
+        a15: u64,
+        a16: u64,
+    ) -> u64 {
+        a1 + a2 + a3 + a4 + a5 + a6 + a7 + a8 + a9 + a10 + a11 + a12 + a13 + a14 + a15 + a16
+    }
+
+    fn list_u8_param(a: Vec<u8>) -> u32 {
+        a.len() as u32
+    }
+
+    fn list_u8_result(len: u32) -> Vec<u8> {
+        vec![0xab; len as usize]
+    }
+
+    fn string_param(a: String) -> u32 {
+        a.len() as u32
+    }
+
+    fn string_result(len: u32) -> String {
+        "x".repeat(len as usize)
+    }
+
+    fn option_param(a: Option<u64>) -> u32 {
+        a.is_some() as u32
+    }
+}